@@ -0,0 +1,45 @@
+#pragma once
+#include <djson/json.hpp>
+#include <memory>
+
+namespace dj {
+/// \brief Parsed JSON tree that allocates all its memory from one arena: Values, Arrays, Objects, strings and keys.
+/// Parsing makes a handful of heap allocations regardless of the size of the text, and destruction releases the arena without visiting the tree.
+/// The tree is immutable. Copies of its values (Json{document.root()}) share its Values (until modified), strings and keys:
+/// the Document must outlive them.
+class Document {
+  public:
+	Document();
+
+	~Document();
+
+	Document(Document&&) noexcept;
+	auto operator=(Document&&) noexcept -> Document&;
+
+	Document(Document const&) = delete;
+	auto operator=(Document const&) -> Document& = delete;
+
+	/// \brief Parse JSON text into a Document.
+	/// \param text Input JSON text, copied into the arena (need not outlive the Document).
+	/// \param mode Parse mode.
+	/// \returns Document if successful, else Error.
+	[[nodiscard]] static auto parse(std::string_view text, ParseMode mode = ParseMode::Auto) -> std::expected<Document, Error>;
+	/// \brief Parse JSON text into a Document.
+	/// Parses on the calling thread (ignores ParseOptions::threads), and ignores ParseFlag::BorrowStrings and ParseFlag::RawNumbers.
+	/// \param text Input JSON text, copied into the arena (need not outlive the Document).
+	/// \param options Parse options.
+	/// \returns Document if successful, else Error.
+	[[nodiscard]] static auto parse(std::string_view text, ParseOptions const& options) -> std::expected<Document, Error>;
+
+	/// \brief Obtain the root value (null if default constructed / moved from).
+	[[nodiscard]] auto root() const -> Json const&;
+
+	/// \brief Obtain the total size of memory obtained by the arena from the heap, in bytes.
+	[[nodiscard]] auto arena_size() const -> std::size_t;
+
+  private:
+	struct Impl;
+
+	std::unique_ptr<Impl> m_impl;
+};
+} // namespace dj
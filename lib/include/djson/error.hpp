@@ -4,7 +4,7 @@
 
 namespace dj {
 /// \brief Various kinds of parse and IO errors.
-/// Contains contextual token and source location if parse error.
+/// Contains contextual token, source location and byte offset if parse error.
 struct Error {
 	enum class Type : std::int8_t {
 		Unknown,
@@ -22,12 +22,19 @@ struct Error {
 		MissingEndComment,
 		IoError,
 		UnsupportedFeature,
+		MaxDepthExceeded,
+		InvalidUtf8,
+		MaxSizeExceeded,
+		MaxStringLengthExceeded,
+		MaxElementsExceeded,
+		MaxNodesExceeded,
 		COUNT_,
 	};
 
 	Type type{Type::Unknown};
 	std::string token{};
 	SrcLoc src_loc{};
+	std::uint64_t offset{};
 };
 
 /// \brief Obtain stringified Error Type.
@@ -0,0 +1,69 @@
+#pragma once
+#include <djson/json.hpp>
+#include <cstdint>
+#include <string_view>
+#include <variant>
+
+namespace dj {
+/// \brief Number parsed from JSON text.
+struct ParsedNumber {
+	/// \brief double if decimal / exponent, std::int64_t if negative, else std::uint64_t.
+	using Payload = std::variant<double, std::uint64_t, std::int64_t>;
+
+	template <NumericT Type>
+	[[nodiscard]] auto as() const -> Type {
+		return std::visit([](auto const n) { return static_cast<Type>(n); }, payload);
+	}
+
+	/// \brief Number in the source text.
+	std::string_view raw{};
+	Payload payload{};
+};
+
+/// \brief Receiver of parse events, in document order.
+/// Default implementations ignore events.
+/// String views passed to callbacks are only valid for the duration of the call:
+/// they view the source text if no unescaping was required, else an internal buffer.
+class EventHandler {
+  public:
+	EventHandler() = default;
+	EventHandler(EventHandler const&) = default;
+	EventHandler(EventHandler&&) = default;
+	auto operator=(EventHandler const&) -> EventHandler& = default;
+	auto operator=(EventHandler&&) -> EventHandler& = default;
+
+	virtual ~EventHandler() = default;
+
+	virtual void on_null() {}
+	virtual void on_bool(bool /*value*/) {}
+	virtual void on_number(ParsedNumber const& /*value*/) {}
+	virtual void on_string(std::string_view /*value*/) {}
+
+	/// \brief Key of the next member of the current Object.
+	virtual void on_key(std::string_view /*key*/) {}
+
+	virtual void begin_array() {}
+	virtual void end_array() {}
+	virtual void begin_object() {}
+	virtual void end_object() {}
+};
+
+/// \brief Parse JSON text, passing values to a handler instead of building a Json.
+/// Empty input produces no events.
+/// Events already received are not rolled back when an error is encountered.
+/// \param text Input JSON text.
+/// \param handler Receiver of parse events.
+/// \param options Parse options.
+/// \returns Error if parsing failed.
+[[nodiscard]] auto parse_events(std::string_view text, EventHandler& handler, ParseOptions const& options) -> std::expected<void, Error>;
+
+/// \brief Parse JSON text, passing values to a handler instead of building a Json.
+/// \param text Input JSON text.
+/// \param handler Receiver of parse events.
+/// \param mode Parse mode.
+/// \returns Error if parsing failed.
+[[nodiscard]] inline auto parse_events(std::string_view const text, EventHandler& handler, ParseMode const mode = ParseMode::Auto)
+	-> std::expected<void, Error> {
+	return parse_events(text, handler, ParseOptions{.mode = mode});
+}
+} // namespace dj
@@ -0,0 +1,38 @@
+#pragma once
+#include <djson/json.hpp>
+#include <memory>
+#include <span>
+
+namespace dj {
+/// \brief Parses JSON text that arrives in chunks, without buffering the whole text.
+/// Only a token split across chunk boundaries is retained between calls to feed().
+class IncrementalParser {
+  public:
+	explicit IncrementalParser(ParseOptions const& options);
+	explicit IncrementalParser(ParseMode mode = ParseMode::Auto);
+
+	~IncrementalParser();
+
+	IncrementalParser(IncrementalParser&&) noexcept;
+	auto operator=(IncrementalParser&&) noexcept -> IncrementalParser&;
+
+	IncrementalParser(IncrementalParser const&) = delete;
+	auto operator=(IncrementalParser const&) -> IncrementalParser& = delete;
+
+	/// \brief Parse the next chunk of text.
+	/// The chunk does not need to outlive this call.
+	/// \param chunk Next chunk of input JSON text.
+	/// \returns false if an error has been encountered (obtain it via finish()).
+	auto feed(std::span<char const> chunk) -> bool;
+
+	/// \brief Parse any remaining text and obtain the result.
+	/// Resets the parser, which can then be fed a new document.
+	/// \returns Json if successful, else Error.
+	[[nodiscard]] auto finish() -> Result;
+
+  private:
+	struct Impl;
+
+	std::unique_ptr<Impl> m_impl;
+};
+} // namespace dj
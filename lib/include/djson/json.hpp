@@ -1,11 +1,16 @@
 #pragma once
 #include <djson/error.hpp>
-#include <djson/string_table.hpp>
+#include <djson/key.hpp>
+#include <djson/key_map.hpp>
+#include <djson/key_pool.hpp>
+#include <array>
+#include <cstring>
 #include <expected>
 #include <format>
-#include <memory>
+#include <limits>
 #include <span>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 namespace dj {
@@ -68,22 +73,93 @@ enum class ParseMode : std::int8_t {
 	Jsonc,
 };
 
+/// \brief Default maximum nesting depth of Arrays / Objects.
+inline constexpr std::uint64_t max_depth_v{256};
+/// \brief Budget that is never exceeded.
+inline constexpr std::uint64_t unlimited_v{std::numeric_limits<std::uint64_t>::max()};
+
+/// \brief Bit flags for parse options.
+struct ParseFlag {
+	enum : std::uint8_t {
+		None = 0,
+		/// \brief Store strings and keys without escapes as views into the input text instead of copying them.
+		/// The input text must outlive the parsed Json (and any copies of it). Ignored by Json::from_file().
+		BorrowStrings = 1 << 0,
+		/// \brief Fail with Error::Type::InvalidUtf8 if a string or key is not well-formed UTF-8.
+		ValidateUtf8 = 1 << 1,
+		/// \brief Store numbers as their text, converting them on first access, and serialize them verbatim.
+		/// Numbers are only validated while parsing: ParsedNumber::payload is not set for EventHandler.
+		RawNumbers = 1 << 2,
+	};
+};
+using ParseFlags = decltype(std::to_underlying(ParseFlag::None));
+
+/// \brief Bit flags for reading files.
+struct FileFlag {
+	enum : std::uint8_t {
+		None = 0,
+		/// \brief Memory map regular files (where supported) instead of reading them into a buffer.
+		MemoryMap = 1 << 0,
+		/// \brief Hint to back memory mapped files with huge pages (Linux only). Ignored if MemoryMap is not set.
+		HugePages = 1 << 1,
+	};
+};
+using FileFlags = decltype(std::to_underlying(FileFlag::None));
+
+/// \brief Parse options.
+struct ParseOptions {
+	ParseMode mode{ParseMode::Auto};
+	/// \brief Maximum nesting depth of Arrays / Objects, exceeding which fails with Error::Type::MaxDepthExceeded.
+	std::uint64_t max_depth{max_depth_v};
+	/// \brief Maximum size of input text in bytes, exceeding which fails with Error::Type::MaxSizeExceeded before parsing.
+	std::uint64_t max_size{unlimited_v};
+	/// \brief Maximum length of a string / key in bytes of input text (before unescaping), exceeding which fails with Error::Type::MaxStringLengthExceeded.
+	std::uint64_t max_string_length{unlimited_v};
+	/// \brief Maximum number of elements / members of an Array / Object, exceeding which fails with Error::Type::MaxElementsExceeded.
+	std::uint64_t max_elements{unlimited_v};
+	/// \brief Maximum number of values (including Arrays / Objects) in the document, exceeding which fails with Error::Type::MaxNodesExceeded.
+	std::uint64_t max_nodes{unlimited_v};
+	/// \brief Number of threads to parse a large top-level Array / Object on, 0 for std::thread::hardware_concurrency().
+	/// Only used by Json::parse() / Json::from_file(), 1 (default) parses on the calling thread.
+	/// Input is always parsed on the calling thread if max_elements or max_nodes is set.
+	std::uint32_t threads{1};
+	/// \brief Only used by Json::from_file(). Pipes and special files are always read into a buffer.
+	FileFlags file_flags{FileFlag::MemoryMap};
+	ParseFlags flags{ParseFlag::None};
+	/// \brief Pool to intern Object keys in (keys borrowed via ParseFlag::BorrowStrings are not interned).
+	/// Must outlive the parsed Json (and any copies of it).
+	KeyPool* key_pool{};
+};
+
 namespace detail {
 struct Value;
 class Parser;
 } // namespace detail
 
 /// \brief Library interface, represents a valid JSON value.
+/// Nulls, booleans, numbers, short strings and borrowed strings are stored inline, other values in a separate allocation
+/// shared between copies (reference counted): long strings are immutable, Arrays and Objects are copied on write, along the path being modified.
+/// Copies may be read and modified concurrently, each on one thread (unless built with DJ_ATOMIC_REFCOUNT=OFF).
 class Json {
   public:
 	using Type = JsonType;
 
-	Json() = default;
-	~Json() = default;
+	Json() noexcept {} // NOLINT(modernize-use-equals-default): required by push_back()'s default argument.
+	~Json() { reset(); }
 
-	Json(Json&&) = default;
-	auto operator=(Json&&) -> Json& = default;
+	Json(Json&& other) noexcept : m_data(other.m_data), m_size(other.m_size), m_kind(std::exchange(other.m_kind, Kind::Null)) {}
+	auto operator=(Json&& other) noexcept -> Json& {
+		// other may be owned by this (eg a member): take it before releasing the current value.
+		auto taken = Json{std::move(other)};
+		swap(*this, taken);
+		return *this;
+	}
 
+	/// \brief Copy other, sharing its Arrays and Objects.
+	/// An Array / Object that has handed out a mutable reference to a member (via operator[](), push_back(), insert_or_assign())
+	/// is copied instead, as that reference may still be written through.
+	/// This is permanent: every later copy copies it again (its members that were not handed out are still shared), even once no such references remain.
+	/// Copies are not pinned: replace a Json with a copy of itself (json = Json{json}) to share it again, invalidating references into it.
 	Json(Json const& other);
 	auto operator=(Json const& other) -> Json&;
 
@@ -99,11 +175,34 @@ class Json {
 	/// \param mode Parse mode.
 	/// \returns Json if successful, else Error.
 	[[nodiscard]] static auto parse(std::string_view text, ParseMode mode = ParseMode::Auto) -> Result;
+	/// \brief Parse JSON text.
+	/// \param text Input JSON text.
+	/// \param options Parse options.
+	/// \returns Json if successful, else Error.
+	[[nodiscard]] static auto parse(std::string_view text, ParseOptions const& options) -> Result;
 	/// \brief Parse JSON from a file.
 	/// \param path Path to JSON file.
 	/// \param mode Parse mode.
 	/// \returns Json if successful, else Error.
 	[[nodiscard]] static auto from_file(std::string_view path, ParseMode mode = ParseMode::Auto) -> Result;
+	/// \brief Parse JSON from a file.
+	/// \param path Path to JSON file.
+	/// \param options Parse options.
+	/// \returns Json if successful, else Error.
+	[[nodiscard]] static auto from_file(std::string_view path, ParseOptions const& options) -> Result;
+	/// \brief Parse JSON text into an existing Json, reusing its nodes, capacity and buffers wherever the shapes match.
+	/// Parses on the calling thread (ignores ParseOptions::threads).
+	/// \param target Json to overwrite, set to null if parsing fails.
+	/// \param text Input JSON text.
+	/// \param options Parse options.
+	/// \returns Error if unsuccessful.
+	[[nodiscard]] static auto parse_into(Json& target, std::string_view text, ParseOptions const& options) -> std::expected<void, Error>;
+	/// \brief Parse JSON text into an existing Json, reusing its nodes, capacity and buffers wherever the shapes match.
+	/// \param target Json to overwrite, set to null if parsing fails.
+	/// \param text Input JSON text.
+	/// \param mode Parse mode.
+	/// \returns Error if unsuccessful.
+	[[nodiscard]] static auto parse_into(Json& target, std::string_view text, ParseMode mode = ParseMode::Auto) -> std::expected<void, Error>;
 
 	/// \brief Obtain a Json representing an empty Array value.
 	[[nodiscard]] static auto empty_array() -> Json const&;
@@ -153,7 +252,7 @@ class Json {
 	}
 
 	[[nodiscard]] auto as_array() const -> std::span<dj::Json const>;
-	[[nodiscard]] auto as_object() const -> StringTable<dj::Json> const&;
+	[[nodiscard]] auto as_object() const -> KeyMapView<dj::Json>;
 
 	void set_null();
 	void set_boolean(bool value);
@@ -199,6 +298,8 @@ class Json {
 	auto push_back(Json value = {}) -> Json&;
 	/// \brief Insert value associated with key into the Object.
 	/// Converts to empty Object value first if not already one.
+	/// Members are in insertion order: an existing key retains its position.
+	/// Inserting invalidates references to other members (like push_back()).
 	/// \param key Key to associate value with.
 	/// \param value Value to insert.
 	/// \returns Reference to inserted value.
@@ -209,6 +310,7 @@ class Json {
 	/// \returns Value if type is Object and key exists, else null.
 	[[nodiscard]] auto operator[](std::string_view key) const -> Json const&;
 	/// \brief Obtain the value associated with the passed key.
+	/// Inserting a new key invalidates references to other members: eg json["new"] = json["old"] may read a dangling reference.
 	/// \param key Key to lookup value for.
 	/// \returns Reference to value if key exists, else newly inserted null value.
 	[[nodiscard]] auto operator[](std::string_view key) -> Json&;
@@ -232,24 +334,91 @@ class Json {
 	/// \returns true if file successfully written.
 	[[nodiscard]] auto to_file(std::string_view path, SerializeOptions const& options = {}) const -> bool;
 
-	friend void swap(Json& a, Json& b) noexcept { std::swap(a.m_value, b.m_value); }
+	friend void swap(Json& a, Json& b) noexcept {
+		std::swap(a.m_data, b.m_data);
+		std::swap(a.m_size, b.m_size);
+		std::swap(a.m_kind, b.m_kind);
+	}
 
-	explicit operator bool() const { return m_value != nullptr; }
+	explicit operator bool() const { return m_kind != Kind::Null; }
 
   private:
 	struct Serializer;
 
-	struct Deleter {
-		void operator()(detail::Value* ptr) const noexcept;
-	};
+	/// \brief Storage of the value: inline, or a pointer to a separately allocated detail::SharedString (Shared) / detail::Value (Value).
+	enum class Kind : std::uint8_t { Null, Bool, I64, U64, F64, Chars, View, Shared, Value };
+
+	/// \brief Maximum length of strings stored inline (Kind::Chars).
+	static constexpr std::size_t chars_capacity_v{14};
 
-	void ensure_impl();
+	template <typename T>
+	[[nodiscard]] auto load() const -> T {
+		static_assert(sizeof(T) <= chars_capacity_v && std::is_trivially_copyable_v<T>);
+		auto ret = T{};
+		std::memcpy(&ret, m_data.data(), sizeof(T));
+		return ret;
+	}
 
-	std::unique_ptr<detail::Value, Deleter> m_value;
+	template <typename T>
+	void store(Kind const kind, T const& value) {
+		static_assert(sizeof(T) <= chars_capacity_v && std::is_trivially_copyable_v<T>);
+		reset();
+		std::memcpy(m_data.data(), &value, sizeof(T));
+		m_kind = kind;
+	}
+
+	[[nodiscard]] auto get_value() const -> detail::Value* { return m_kind == Kind::Value ? load<detail::Value*>() : nullptr; }
+	[[nodiscard]] auto get_chars() const -> std::string_view { return std::string_view{m_data.data(), m_size}; }
+	/// \brief Borrowed string (Kind::View): pointer followed by 48-bit length (low 32 bits, high 16 bits).
+	[[nodiscard]] auto get_view() const -> std::string_view {
+		auto const* data = load<char const*>();
+		auto low = std::uint32_t{};
+		auto high = std::uint16_t{};
+		std::memcpy(&low, m_data.data() + sizeof(data), sizeof(low));
+		std::memcpy(&high, m_data.data() + sizeof(data) + sizeof(low), sizeof(high));
+		return std::string_view{data, std::size_t(low) | (std::size_t(high) << 32)};
+	}
+
+	/// \pre text.size() <= chars_capacity_v.
+	void set_chars(std::string_view const text) {
+		reset();
+		if (!text.empty()) { std::memcpy(m_data.data(), text.data(), text.size()); }
+		m_size = std::uint8_t(text.size());
+		m_kind = Kind::Chars;
+	}
+
+	/// \pre text.data() is not null, text.size() fits in 48 bits.
+	void set_view(std::string_view const text) {
+		store(Kind::View, text.data());
+		auto const low = std::uint32_t(text.size());
+		auto const high = std::uint16_t(std::uint64_t(text.size()) >> 32);
+		std::memcpy(m_data.data() + sizeof(char const*), &low, sizeof(low));
+		std::memcpy(m_data.data() + sizeof(char const*) + sizeof(low), &high, sizeof(high));
+	}
+
+	void reset() noexcept {
+		if (m_kind == Kind::Shared || m_kind == Kind::Value) { release(); }
+		m_kind = Kind::Null;
+	}
+
+	/// \brief Take another reference to the string (Kind::Shared) / Value (Kind::Value).
+	void retain() const;
+	/// \brief Drop the reference to the string (Kind::Shared) / Value (Kind::Value), destroying it if the last one.
+	void release() noexcept;
+
+	template <NumericT T>
+	[[nodiscard]] auto get_number(T fallback) const -> T;
+
+	alignas(std::uint64_t) std::array<char, chars_capacity_v> m_data{};
+	/// \brief Length of inline string (Kind::Chars).
+	std::uint8_t m_size{};
+	Kind m_kind{Kind::Null};
 
 	friend class detail::Parser;
 };
 
+static_assert(sizeof(Json) == 16);
+
 [[nodiscard]] inline auto to_string(Json const& json, SerializeOptions const& options = {}) { return json.serialize(options); }
 
 /// \brief Convert input text to escaped string.
@@ -0,0 +1,51 @@
+#pragma once
+#include <compare>
+#include <format>
+#include <string>
+#include <string_view>
+
+namespace dj {
+/// \brief Object key: owns its text, or borrows it from source text that outlives it.
+class Key {
+  public:
+	Key() = default;
+
+	explicit(false) Key(std::string text) : m_text(std::move(text)) {}
+	explicit(false) Key(std::string_view const text) : m_text(text) {}
+	explicit(false) Key(char const* text) : m_text(text) {}
+
+	/// \brief Create a Key that views text without copying it.
+	/// \param text Text that must outlive the returned Key (and any copies of it).
+	[[nodiscard]] static auto borrow(std::string_view const text) -> Key {
+		auto ret = Key{};
+		ret.m_borrowed = text;
+		return ret;
+	}
+
+	[[nodiscard]] auto is_borrowed() const -> bool { return m_borrowed.data() != nullptr; }
+
+	[[nodiscard]] auto view() const -> std::string_view { return is_borrowed() ? m_borrowed : std::string_view{m_text}; }
+	[[nodiscard]] auto str() const -> std::string { return std::string{view()}; }
+
+	explicit(false) operator std::string_view() const { return view(); }
+
+	/// \brief Keys interned in the same KeyPool compare equal by address.
+	friend auto operator==(Key const& lhs, Key const& rhs) -> bool {
+		auto const l = lhs.view();
+		auto const r = rhs.view();
+		return (l.data() == r.data() && l.size() == r.size()) || l == r;
+	}
+	friend auto operator==(Key const& lhs, std::string_view const rhs) -> bool { return lhs.view() == rhs; }
+	friend auto operator<=>(Key const& lhs, std::string_view const rhs) -> std::strong_ordering { return lhs.view() <=> rhs; }
+
+  private:
+	std::string m_text{};
+	std::string_view m_borrowed{};
+};
+} // namespace dj
+
+/// \brief Specialization for std::format (and related).
+template <>
+struct std::formatter<dj::Key> : std::formatter<std::string_view> {
+	auto format(dj::Key const& key, std::format_context& fc) const { return std::formatter<std::string_view>::format(key.view(), fc); }
+};
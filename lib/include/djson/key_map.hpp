@@ -0,0 +1,148 @@
+#pragma once
+#include <djson/key.hpp>
+#include <djson/string_table.hpp>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace dj {
+/// \brief Key map in insertion order: a flat vector of members, searched linearly while small, indexed by hash once larger.
+/// Inserting may invalidate iterators and references to members (like a vector).
+/// Allocates from the default memory resource, unless owned by a Document (which allocates from its arena).
+template <typename Value>
+class KeyMap {
+  public:
+	using value_type = std::pair<Key, Value>;
+	using iterator = value_type*;
+	using const_iterator = value_type const*;
+	using allocator_type = std::pmr::polymorphic_allocator<>;
+
+	/// \brief Maximum number of members searched linearly: larger maps are indexed.
+	static constexpr std::size_t flat_size_v{8};
+
+	KeyMap() = default;
+	explicit KeyMap(allocator_type const& allocator) : m_members(allocator), m_index(allocator) {}
+
+	[[nodiscard]] auto get_allocator() const -> allocator_type { return m_members.get_allocator(); }
+
+	[[nodiscard]] auto begin() -> iterator { return m_members.data(); }
+	[[nodiscard]] auto end() -> iterator { return m_members.data() + m_members.size(); }
+	[[nodiscard]] auto begin() const -> const_iterator { return m_members.data(); }
+	[[nodiscard]] auto end() const -> const_iterator { return m_members.data() + m_members.size(); }
+
+	[[nodiscard]] auto size() const -> std::size_t { return m_members.size(); }
+	[[nodiscard]] auto empty() const -> bool { return m_members.empty(); }
+
+	[[nodiscard]] auto find(std::string_view const key) -> iterator { return begin() + find_position(key); }
+	[[nodiscard]] auto find(std::string_view const key) const -> const_iterator { return begin() + find_position(key); }
+	[[nodiscard]] auto contains(std::string_view const key) const -> bool { return find_position(key) < size(); }
+
+	void reserve(std::size_t const count) {
+		m_members.reserve(count);
+		if (count > flat_size_v && m_index.size() < 2 * count) { rebuild_index(std::bit_ceil(2 * count)); }
+	}
+
+	/// \brief Remove all members, retaining capacity.
+	void clear() {
+		m_members.clear();
+		m_index.clear();
+	}
+
+	/// \brief Append a member constructed from args, unless key is already present.
+	/// \returns Iterator to the member with key, and whether it was inserted.
+	template <typename... Args>
+	auto try_emplace(Key key, Args&&... args) -> std::pair<iterator, bool> {
+		auto const position = find_position(key.view());
+		if (position < size()) { return {begin() + position, false}; }
+		m_members.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+		on_append();
+		return {end() - 1, true};
+	}
+
+	/// \brief Append a member, or assign value to the member with key if present (which retains its position).
+	/// \returns Iterator to the member with key, and whether it was inserted.
+	template <typename Type>
+	auto insert_or_assign(Key key, Type&& value) -> std::pair<iterator, bool> {
+		auto ret = try_emplace(std::move(key), std::forward<Type>(value));
+		if (!ret.second) { ret.first->second = std::forward<Type>(value); }
+		return ret;
+	}
+
+	friend void swap(KeyMap& a, KeyMap& b) noexcept {
+		a.m_members.swap(b.m_members);
+		a.m_index.swap(b.m_index);
+	}
+
+  private:
+	/// \returns Position of the member with key, size() if absent.
+	[[nodiscard]] auto find_position(std::string_view const key) const -> std::size_t {
+		if (m_index.empty()) {
+			for (auto position = 0uz; position < m_members.size(); ++position) {
+				if (m_members[position].first.view() == key) { return position; }
+			}
+			return m_members.size();
+		}
+		auto const mask = m_index.size() - 1;
+		for (auto slot = StringHash{}(key) & mask;; slot = (slot + 1) & mask) {
+			auto const entry = m_index[slot];
+			if (entry == 0) { return m_members.size(); }
+			if (m_members[entry - 1].first.view() == key) { return entry - 1; }
+		}
+	}
+
+	void on_append() {
+		if (m_index.empty() && m_members.size() <= flat_size_v) { return; }
+		// at most half full.
+		if (m_index.size() < 2 * m_members.size()) {
+			rebuild_index(std::bit_ceil(4 * m_members.size()));
+			return;
+		}
+		add_to_index(m_members.size() - 1);
+	}
+
+	void rebuild_index(std::size_t const capacity) {
+		m_index.assign(capacity, 0);
+		for (auto position = 0uz; position < m_members.size(); ++position) { add_to_index(position); }
+	}
+
+	void add_to_index(std::size_t const position) {
+		auto const mask = m_index.size() - 1;
+		auto slot = StringHash{}(m_members[position].first.view()) & mask;
+		while (m_index[slot] != 0) { slot = (slot + 1) & mask; }
+		m_index[slot] = std::uint32_t(position + 1);
+	}
+
+	std::pmr::vector<value_type> m_members{};
+	/// \brief Open addressing hash index of member positions (+1, 0 for empty slots), empty while flat.
+	std::pmr::vector<std::uint32_t> m_index{};
+};
+
+/// \brief Read-only view of a KeyMap (or of none: empty).
+template <typename Value>
+class KeyMapView {
+  public:
+	using value_type = typename KeyMap<Value>::value_type;
+	using iterator = typename KeyMap<Value>::const_iterator;
+	using const_iterator = iterator;
+
+	KeyMapView() = default;
+	explicit(false) KeyMapView(KeyMap<Value> const& map) : m_map(&map) {}
+
+	[[nodiscard]] auto begin() const -> iterator { return m_map != nullptr ? m_map->begin() : iterator{}; }
+	[[nodiscard]] auto end() const -> iterator { return m_map != nullptr ? m_map->end() : iterator{}; }
+
+	[[nodiscard]] auto size() const -> std::size_t { return m_map != nullptr ? m_map->size() : 0; }
+	[[nodiscard]] auto empty() const -> bool { return size() == 0; }
+
+	[[nodiscard]] auto find(std::string_view const key) const -> iterator { return m_map != nullptr ? m_map->find(key) : iterator{}; }
+	[[nodiscard]] auto contains(std::string_view const key) const -> bool { return m_map != nullptr && m_map->contains(key); }
+
+  private:
+	KeyMap<Value> const* m_map{};
+};
+} // namespace dj
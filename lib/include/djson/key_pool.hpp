@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+namespace dj {
+/// \brief Interns Object keys: identical keys share one immutable allocation (and compare equal by address).
+/// Set ParseOptions::key_pool to intern the keys of parsed Objects, reusable across parses of similar documents.
+/// Interned keys view the pool's storage: it must outlive all Json parsed with it (and any copies of them).
+/// Thread safe: may be shared by concurrent parses.
+class KeyPool {
+  public:
+	KeyPool();
+
+	~KeyPool();
+
+	KeyPool(KeyPool&&) noexcept;
+	auto operator=(KeyPool&&) noexcept -> KeyPool&;
+
+	KeyPool(KeyPool const&) = delete;
+	auto operator=(KeyPool const&) -> KeyPool& = delete;
+
+	/// \brief Obtain the interned copy of text, adding it if not present.
+	/// \returns View that is valid for the lifetime of the pool (including after moves).
+	[[nodiscard]] auto intern(std::string_view text) -> std::string_view;
+
+	/// \brief Obtain the number of unique keys interned.
+	[[nodiscard]] auto key_count() const -> std::size_t;
+	/// \brief Obtain the total size of unique keys interned, in bytes.
+	[[nodiscard]] auto text_size() const -> std::size_t;
+
+  private:
+	struct Impl;
+
+	std::unique_ptr<Impl> m_impl;
+};
+} // namespace dj
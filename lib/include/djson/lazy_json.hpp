@@ -0,0 +1,183 @@
+#pragma once
+#include <djson/json.hpp>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+namespace dj {
+/// \brief Position of an Array element / Object member in the source text.
+/// A value offset of 0 represents the end of the range.
+struct LazyCursor {
+	std::uint64_t key{};
+	std::uint64_t value{};
+};
+
+template <typename Element>
+class LazyRange;
+
+/// \brief On-demand view of JSON text.
+/// Values are only located and parsed when navigated to: untouched subtrees are skipped
+/// by bracket matching, without allocating.
+/// The source text must outlive all LazyJson instances obtained from it.
+/// Input is not validated beyond what is navigated: malformed values read as null / fallbacks.
+/// Use to_json() to parse (and validate) a subtree fully.
+class LazyJson {
+  public:
+	using Type = JsonType;
+	using Member = std::pair<std::string_view, LazyJson>;
+
+	/// \brief Locate the root value of JSON text.
+	/// \param text Input JSON text, must outlive the returned LazyJson.
+	/// \param mode Parse mode.
+	/// \returns LazyJson if the root value was found, else Error.
+	[[nodiscard]] static auto parse(std::string_view text, ParseMode mode = ParseMode::Auto) -> std::expected<LazyJson, Error>;
+
+	LazyJson() = default;
+
+	/// \brief Obtain the value type of this LazyJson, inferred from its first character.
+	[[nodiscard]] auto get_type() const -> Type;
+
+	[[nodiscard]] auto is_null() const -> bool { return get_type() == Type::Null; }
+	[[nodiscard]] auto is_boolean() const -> bool { return get_type() == Type::Boolean; }
+	[[nodiscard]] auto is_number() const -> bool { return get_type() == Type::Number; }
+	[[nodiscard]] auto is_string() const -> bool { return get_type() == Type::String; }
+	[[nodiscard]] auto is_array() const -> bool { return get_type() == Type::Array; }
+	[[nodiscard]] auto is_object() const -> bool { return get_type() == Type::Object; }
+
+	[[nodiscard]] auto as_bool(bool fallback = {}) const -> bool;
+	[[nodiscard]] auto as_double(double fallback = {}) const -> double;
+	[[nodiscard]] auto as_u64(std::uint64_t fallback = {}) const -> std::uint64_t;
+	[[nodiscard]] auto as_i64(std::int64_t fallback = {}) const -> std::int64_t;
+
+	/// \brief Obtain a view of the string in the source text, escape sequences are not processed.
+	[[nodiscard]] auto as_string_view(std::string_view fallback = {}) const -> std::string_view;
+	/// \brief Obtain the unescaped string.
+	[[nodiscard]] auto as_string(std::string_view fallback = {}) const -> std::string;
+
+	template <NumericT Type>
+	[[nodiscard]] auto as_number(Type const fallback = {}) const -> Type {
+		if constexpr (std::signed_integral<Type>) {
+			return static_cast<Type>(as_i64(static_cast<std::int64_t>(fallback)));
+		} else if constexpr (std::unsigned_integral<Type>) {
+			return static_cast<Type>(as_u64(static_cast<std::uint64_t>(fallback)));
+		} else {
+			return static_cast<Type>(as_double(static_cast<double>(fallback)));
+		}
+	}
+
+	template <GettableT Type>
+	[[nodiscard]] auto as(Type const& fallback = {}) const -> Type {
+		if constexpr (std::same_as<Type, bool>) {
+			return as_bool(fallback);
+		} else if constexpr (NumericT<Type>) {
+			return as_number(fallback);
+		} else if constexpr (std::same_as<Type, std::string_view>) {
+			return as_string_view(fallback);
+		} else {
+			return as_string(fallback);
+		}
+	}
+
+	[[nodiscard]] auto as_array() const -> LazyRange<LazyJson>;
+	[[nodiscard]] auto as_object() const -> LazyRange<Member>;
+
+	/// \brief Obtain the value associated with the passed key.
+	/// \param key Key to lookup value for.
+	/// \returns Value if type is Object and key exists, else null.
+	[[nodiscard]] auto operator[](std::string_view key) const -> LazyJson;
+	/// \brief Obtain the value at the passed index.
+	/// \param index Index to access value for.
+	/// \returns Value at index if type is Array and index is less than size, else null.
+	[[nodiscard]] auto operator[](std::size_t index) const -> LazyJson;
+
+	/// \brief Obtain the source text of this value.
+	[[nodiscard]] auto get_text() const -> std::string_view;
+
+	/// \brief Parse this value into a Json.
+	/// \returns Json if successful, else Error (located relative to the whole source text).
+	[[nodiscard]] auto to_json() const -> Result;
+
+	explicit operator bool() const { return !m_source.empty(); }
+
+  private:
+	LazyJson(std::string_view const source, std::uint64_t const offset, ParseMode const mode) : m_source(source), m_offset(offset), m_mode(mode) {}
+
+	[[nodiscard]] auto at(std::uint64_t offset) const -> LazyJson { return LazyJson{m_source, offset, m_mode}; }
+	[[nodiscard]] auto first_child(bool is_object) const -> LazyCursor;
+	[[nodiscard]] auto next_child(LazyCursor cursor, bool is_object) const -> LazyCursor;
+
+	std::string_view m_source{};
+	std::uint64_t m_offset{};
+	ParseMode m_mode{ParseMode::Strict};
+
+	template <typename Element>
+	friend class LazyRange;
+};
+
+/// \brief Forward range over the elements of an Array or the members of an Object in a LazyJson.
+/// \tparam Element LazyJson (Array) or LazyJson::Member (Object).
+template <typename Element>
+class LazyRange {
+  public:
+	class Iterator;
+
+	[[nodiscard]] auto begin() const -> Iterator;
+	[[nodiscard]] auto end() const -> Iterator { return {}; }
+
+	[[nodiscard]] auto empty() const -> bool { return m_first.value == 0; }
+
+  private:
+	LazyRange(LazyJson const& parent, LazyCursor const first) : m_parent(parent), m_first(first) {}
+
+	LazyJson m_parent{};
+	LazyCursor m_first{};
+
+	friend class LazyJson;
+};
+
+template <typename Element>
+class LazyRange<Element>::Iterator {
+  public:
+	using value_type = Element;
+	using difference_type = std::ptrdiff_t;
+	using iterator_concept = std::forward_iterator_tag;
+
+	Iterator() = default;
+
+	auto operator*() const -> value_type {
+		auto const value = m_parent.at(m_cursor.value);
+		if constexpr (std::same_as<Element, LazyJson>) {
+			return value;
+		} else {
+			return value_type{m_parent.at(m_cursor.key).as_string_view(), value};
+		}
+	}
+
+	auto operator++() -> Iterator& {
+		m_cursor = m_parent.next_child(m_cursor, !std::same_as<Element, LazyJson>);
+		return *this;
+	}
+
+	auto operator++(int) -> Iterator {
+		auto ret = *this;
+		++*this;
+		return ret;
+	}
+
+	auto operator==(Iterator const& rhs) const -> bool { return m_cursor.value == rhs.m_cursor.value; }
+
+  private:
+	Iterator(LazyJson const& parent, LazyCursor const cursor) : m_parent(parent), m_cursor(cursor) {}
+
+	LazyJson m_parent{};
+	LazyCursor m_cursor{};
+
+	friend class LazyRange;
+};
+
+template <typename Element>
+auto LazyRange<Element>::begin() const -> Iterator {
+	return Iterator{m_parent, m_first};
+}
+} // namespace dj
@@ -0,0 +1,43 @@
+#pragma once
+#include <djson/json.hpp>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace dj {
+/// \brief Options for parse_lines().
+struct LinesOptions {
+	/// \brief Options used to parse each line.
+	ParseOptions parse{};
+	/// \brief Number of threads to parse lines on, 0 for std::thread::hardware_concurrency().
+	std::uint32_t threads{};
+	/// \brief Number of lines parsed at a time by the streaming overload, bounding its memory usage.
+	std::size_t batch_size{4096};
+};
+
+/// \brief Parse result of a line of NDJSON / JSON Lines text.
+struct ParsedLine {
+	/// \brief Line number in the whole text, starting at 1.
+	std::uint64_t line{};
+	/// \brief Json if successful, else Error (located relative to the whole text).
+	Result result{};
+};
+
+/// \brief Callback for the streaming overload of parse_lines().
+using LineCallback = std::function<void(ParsedLine)>;
+
+/// \brief Parse NDJSON / JSON Lines text: one JSON value per line, blank lines are skipped.
+/// Lines are parsed in parallel.
+/// \param text Input text.
+/// \param options Options.
+/// \returns Parsed lines, in input order.
+[[nodiscard]] auto parse_lines(std::string_view text, LinesOptions const& options = {}) -> std::vector<ParsedLine>;
+
+/// \brief Parse NDJSON / JSON Lines text: one JSON value per line, blank lines are skipped.
+/// Lines are parsed in parallel, LinesOptions::batch_size at a time.
+/// \param text Input text.
+/// \param callback Invoked on the calling thread with each parsed line, in input order.
+/// \param options Options.
+void parse_lines(std::string_view text, LineCallback const& callback, LinesOptions const& options = {});
+} // namespace dj
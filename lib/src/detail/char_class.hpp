@@ -0,0 +1,55 @@
+#pragma once
+#include <detail/token.hpp>
+#include <array>
+#include <cstdint>
+
+namespace dj::detail {
+/// \brief Token kind implied by the first character of a lexeme.
+enum class Lead : std::int8_t { None, Operator, Keyword, Number, Quote, Slash };
+
+struct CharClass {
+	struct Flag {
+		enum : std::uint8_t {
+			None = 0,
+			Space = 1 << 0,
+			Number = 1 << 1,
+		};
+	};
+
+	Lead lead{Lead::None};
+	/// \brief Single character operator, or keyword (null / true / false) to match.
+	token::Operator op{token::Operator::COUNT_};
+	std::uint8_t flags{Flag::None};
+};
+
+inline constexpr auto char_class_v = [] {
+	auto ret = std::array<CharClass, 256>{};
+	auto const set = [&ret](char const c) -> CharClass& { return ret.at(static_cast<unsigned char>(c)); };
+
+	for (char const c : {' ', '\t', '\n', '\r'}) { set(c).flags = CharClass::Flag::Space; }
+	for (char const c : {'.', 'e', 'E', '+'}) { set(c).flags = CharClass::Flag::Number; }
+	for (char c = '0'; c <= '9'; ++c) { set(c) = CharClass{.lead = Lead::Number, .flags = CharClass::Flag::Number}; }
+	set('-') = CharClass{.lead = Lead::Number, .flags = CharClass::Flag::Number};
+
+	set(':') = CharClass{.lead = Lead::Operator, .op = token::Operator::Colon};
+	set(',') = CharClass{.lead = Lead::Operator, .op = token::Operator::Comma};
+	set('{') = CharClass{.lead = Lead::Operator, .op = token::Operator::BraceLeft};
+	set('}') = CharClass{.lead = Lead::Operator, .op = token::Operator::BraceRight};
+	set('[') = CharClass{.lead = Lead::Operator, .op = token::Operator::SquareLeft};
+	set(']') = CharClass{.lead = Lead::Operator, .op = token::Operator::SquareRight};
+
+	set('n') = CharClass{.lead = Lead::Keyword, .op = token::Operator::Null};
+	set('t') = CharClass{.lead = Lead::Keyword, .op = token::Operator::True};
+	set('f') = CharClass{.lead = Lead::Keyword, .op = token::Operator::False};
+
+	set('"').lead = Lead::Quote;
+	set('/').lead = Lead::Slash;
+	return ret;
+}();
+
+[[nodiscard]] constexpr auto get_char_class(char const c) -> CharClass const& { return char_class_v[static_cast<unsigned char>(c)]; }
+
+[[nodiscard]] constexpr auto is_space(char const c) -> bool { return (get_char_class(c).flags & CharClass::Flag::Space) != 0; }
+
+[[nodiscard]] constexpr auto is_part_number(char const c) -> bool { return (get_char_class(c).flags & CharClass::Flag::Number) != 0; }
+} // namespace dj::detail
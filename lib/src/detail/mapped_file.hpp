@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+namespace dj::detail {
+/// \brief Read-only memory mapping of a regular file.
+class MappedFile {
+  public:
+	/// \brief Map a file into memory.
+	/// \param path Path to file.
+	/// \param huge_pages Hint to back the mapping with huge pages (ignored where unsupported).
+	/// \returns MappedFile if path is a regular file that could be mapped, else nullopt (eg empty / special files, pipes).
+	[[nodiscard]] static auto map(std::string_view path, bool huge_pages) -> std::optional<MappedFile>;
+
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(MappedFile&& other) noexcept;
+	auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+	MappedFile(MappedFile const&) = delete;
+	auto operator=(MappedFile const&) -> MappedFile& = delete;
+
+	[[nodiscard]] auto get_text() const -> std::string_view { return {static_cast<char const*>(m_data), m_size}; }
+
+  private:
+	void* m_data{};
+	std::size_t m_size{};
+};
+} // namespace dj::detail
@@ -0,0 +1,150 @@
+#pragma once
+#include <detail/token.hpp>
+#include <detail/value.hpp>
+#include <array>
+#include <cfloat>
+#include <charconv>
+#include <limits>
+#include <optional>
+
+namespace dj::detail {
+template <typename T>
+[[nodiscard]] auto from_chars(std::string_view const text) -> std::optional<T> {
+	auto ret = T{};
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	auto const* end = text.data() + text.size();
+	auto const [ptr, ec] = std::from_chars(text.data(), end, ret);
+	if (ec != std::errc{} || ptr != end) { return {}; }
+	return ret;
+}
+
+/// \brief Single pass number parser: validates the JSON number grammar while accumulating digits.
+class NumberParser {
+  public:
+	explicit constexpr NumberParser(std::string_view const text) : m_text(text) {}
+
+	/// \brief Convert to double (if decimal / exponent), i64 (if negative), or u64.
+	/// Integers out of range convert to double.
+	/// \returns nullopt if text is not a valid JSON number (or out of range of double).
+	[[nodiscard]] auto parse() -> std::optional<literal::Number::Payload> {
+		if (!walk()) { return {}; }
+		return convert();
+	}
+
+	/// \brief Check whether text is a valid JSON number (in range of double), converting only if the range is in doubt.
+	[[nodiscard]] auto validate() -> bool {
+		if (!walk()) { return false; }
+		if (m_mantissa == 0 || (m_exponent > -min_safe_exponent_v && m_exponent < max_safe_exponent_v)) { return true; }
+		return convert().has_value();
+	}
+
+  private:
+	/// \brief Largest integer exactly representable as a double.
+	static constexpr auto max_exact_v = std::uint64_t{1} << std::numeric_limits<double>::digits;
+	/// \brief Magnitude of std::int64_t's minimum.
+	static constexpr auto max_negative_v = std::uint64_t{1} << 63;
+	/// \brief Powers of 10 exactly representable as doubles.
+	static constexpr auto pow10_v = std::array{1e0,	 1e1,  1e2,	 1e3,  1e4,	 1e5,  1e6,	 1e7,  1e8,	 1e9,  1e10, 1e11,
+											   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	/// \brief Clamp for exponent digits, beyond which the result is 0 or out of range regardless.
+	static constexpr auto max_exponent_v = 100'000;
+	/// \brief Exponents of 10 that cannot be out of range of double for any mantissa.
+	static constexpr auto min_safe_exponent_v = 300;
+	static constexpr auto max_safe_exponent_v = 280;
+
+	constexpr auto walk() -> bool {
+		m_negative = consume('-');
+		return integer() && fraction() && exponent() && m_index == m_text.size();
+	}
+
+	[[nodiscard]] auto convert() const -> std::optional<literal::Number::Payload> {
+		if (!m_is_decimal && !m_overflow) {
+			if (!m_negative) { return m_mantissa; }
+			if (m_mantissa <= max_negative_v) { return std::int64_t(0 - m_mantissa); }
+		}
+		if (auto const ret = fast_double()) { return *ret; }
+		// correctly rounded slow path.
+		return from_chars<double>(m_text);
+	}
+
+	[[nodiscard]] static constexpr auto is_digit(char const c) -> bool { return c >= '0' && c <= '9'; }
+
+	[[nodiscard]] constexpr auto peek() const -> char { return m_index < m_text.size() ? m_text[m_index] : '\0'; }
+
+	constexpr auto consume(char const c) -> bool {
+		if (peek() != c) { return false; }
+		++m_index;
+		return true;
+	}
+
+	/// \returns false if the digit was dropped (mantissa overflow).
+	constexpr auto accumulate(char const c) -> bool {
+		auto const digit = std::uint64_t(c - '0');
+		if (m_overflow || m_mantissa > (std::numeric_limits<std::uint64_t>::max() - digit) / 10) {
+			m_overflow = true;
+			return false;
+		}
+		m_mantissa = (m_mantissa * 10) + digit;
+		return true;
+	}
+
+	/// \brief Digits after the first cannot follow a leading zero.
+	constexpr auto integer() -> bool {
+		if (consume('0')) { return true; }
+		if (!is_digit(peek())) { return false; }
+		for (; is_digit(peek()); ++m_index) {
+			// dropped digits still scale the mantissa.
+			if (!accumulate(m_text[m_index])) { ++m_exponent; }
+		}
+		return true;
+	}
+
+	constexpr auto fraction() -> bool {
+		if (!consume('.')) { return true; }
+		m_is_decimal = true;
+		if (!is_digit(peek())) { return false; }
+		for (; is_digit(peek()); ++m_index) {
+			if (accumulate(m_text[m_index])) { --m_exponent; }
+		}
+		return true;
+	}
+
+	constexpr auto exponent() -> bool {
+		if (!consume('e') && !consume('E')) { return true; }
+		m_is_decimal = true;
+		auto const negative = consume('-');
+		if (!negative) { consume('+'); }
+		if (!is_digit(peek())) { return false; }
+		auto value = 0;
+		for (; is_digit(peek()); ++m_index) {
+			if (value < max_exponent_v) { value = (value * 10) + (m_text[m_index] - '0'); }
+		}
+		m_exponent += negative ? -value : value;
+		return true;
+	}
+
+	/// \brief Exact when the mantissa and power of 10 are both exactly representable: a single IEEE operation rounds correctly.
+	[[nodiscard]] auto fast_double() const -> std::optional<double> {
+		// excess precision (eg x87) would round twice.
+		if constexpr (!std::numeric_limits<double>::is_iec559 || FLT_EVAL_METHOD != 0) { return {}; }
+		if (m_overflow || m_mantissa > max_exact_v) { return {}; }
+		auto const power = m_exponent < 0 ? -m_exponent : m_exponent;
+		if (power >= int(pow10_v.size())) { return {}; }
+		auto ret = static_cast<double>(m_mantissa);
+		ret = m_exponent < 0 ? ret / pow10_v.at(std::size_t(power)) : ret * pow10_v.at(std::size_t(power));
+		return m_negative ? -ret : ret;
+	}
+
+	std::string_view m_text{};
+	std::size_t m_index{};
+
+	std::uint64_t m_mantissa{};
+	int m_exponent{};
+	bool m_negative{};
+	bool m_is_decimal{};
+	bool m_overflow{};
+};
+
+/// \brief Convert a number token to double (if decimal / exponent), i64 (if negative), or u64.
+[[nodiscard]] inline auto to_number(token::Number const& in) -> std::optional<literal::Number::Payload> { return NumberParser{in.raw_str}.parse(); }
+} // namespace dj::detail
@@ -0,0 +1,41 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace dj::detail {
+/// \brief Resolve a requested thread count: 0 selects std::thread::hardware_concurrency().
+[[nodiscard]] inline auto resolve_thread_count(std::uint32_t const requested) -> std::uint32_t {
+	if (requested > 0) { return requested; }
+	return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+/// \brief Invoke func(index) for each index in [0, count), distributed across threads.
+/// The calling thread participates, and indices are claimed in groups of grain to limit contention.
+/// Returns once all invocations have completed.
+/// Workers are std::jthreads: djson links Threads::Threads for them (lib/CMakeLists.txt).
+template <typename Func>
+void parallel_for(std::size_t const count, std::uint32_t const thread_count, std::size_t const grain, Func const& func) {
+	auto const groups = (count + grain - 1) / grain;
+	auto const workers = std::min<std::size_t>(resolve_thread_count(thread_count), groups);
+	if (workers <= 1) {
+		for (auto index = 0uz; index < count; ++index) { func(index); }
+		return;
+	}
+
+	auto next = std::atomic<std::size_t>{};
+	auto const work = [&] {
+		for (auto first = next.fetch_add(grain); first < count; first = next.fetch_add(grain)) {
+			auto const last = std::min(first + grain, count);
+			for (auto index = first; index < last; ++index) { func(index); }
+		}
+	};
+
+	auto threads = std::vector<std::jthread>{};
+	threads.reserve(workers - 1);
+	for (auto i = 1uz; i < workers; ++i) { threads.emplace_back(work); }
+	work();
+}
+} // namespace dj::detail
@@ -1,47 +1,290 @@
 #pragma once
+#include <detail/number.hpp>
 #include <detail/scanner.hpp>
+#include <detail/shared_string.hpp>
+#include <detail/unescape.hpp>
+#include <detail/utf8.hpp>
 #include <detail/value.hpp>
+#include <detail/visitor.hpp>
+#include <djson/events.hpp>
 #include <djson/json.hpp>
+#include <array>
+#include <optional>
 
 namespace dj::detail {
-class Parser {
+/// \brief Non-owning parse error, only converted to Error (which owns its token) at the API boundary.
+struct ParseError {
+	Error::Type type{};
+	std::string_view token{};
+	std::uint64_t offset{};
+};
+
+[[nodiscard]] auto to_parse_error(ScanError const& error) -> ParseError;
+
+/// \brief Check whether a comment enables JSONC mode when the first token in ParseMode::Auto.
+[[nodiscard]] auto is_jsonc_header(std::string_view comment) -> bool;
+
+/// \brief Creates keys and strings per parse options: borrowed from source text, interned in a KeyPool, copied into an arena, or owned.
+class StringFactory {
   public:
-	[[nodiscard]] static auto make_json(Value::Payload payload) -> Json;
+	/// \param options Uses ParseFlag::BorrowStrings and key_pool.
+	/// \param text Text to borrow strings and keys from (when they are views into it), if ParseFlag::BorrowStrings is set.
+	/// \param arena Memory resource to copy strings and keys into (and borrow them from) instead of owning them, if set.
+	explicit StringFactory(ParseOptions const& options = {}, std::string_view text = {}, std::pmr::memory_resource* arena = {});
 
-	explicit Parser(std::string_view text, ParseMode mode);
+	[[nodiscard]] auto make_key(std::string_view key) -> Key;
+	/// \brief Replace out (equal to key) only if either would not own its text.
+	void reuse_key(Key& out, std::string_view key);
 
-	[[nodiscard]] auto parse() -> Result;
+	[[nodiscard]] auto make_string(std::string_view value) const -> Json;
+	/// \brief Assign value to out, reusing its buffer if it solely owns a long enough string.
+	void assign_string(Json& out, std::string_view value) const;
 
   private:
-	[[nodiscard]] auto next_token() -> Token;
-	[[nodiscard]] auto next_non_comment() -> Token;
-	void handle_comment(Token const& token) const;
-	void advance();
-	void consume(token::Operator expected, Error::Type on_error);
+	[[nodiscard]] auto is_borrowable(std::string_view text) const -> bool;
+	[[nodiscard]] auto intern(std::string_view key) -> std::string_view;
+	[[nodiscard]] auto copy_to_arena(std::string_view text) const -> std::string_view;
+
+	std::string_view m_source{};
+	KeyPool* m_key_pool{};
+	std::pmr::memory_resource* m_arena{};
+	/// \brief Recently interned keys, direct mapped: hits skip hashing and locking the pool.
+	std::array<std::string_view, 64> m_interned{};
+};
+
+/// \brief Builds a Json tree from parse events.
+class JsonBuilder final : public EventHandler {
+  public:
+	/// \param options Uses ParseFlag::BorrowStrings, ParseFlag::RawNumbers, and key_pool.
+	/// \param text Text to borrow strings and keys from (when they are views into it), if ParseFlag::BorrowStrings is set.
+	/// \param arena Memory resource to allocate the whole tree from (Values, containers, strings and keys) instead of the heap, if set.
+	/// The tree is then never destroyed (including on error): it must be released with the arena.
+	explicit JsonBuilder(ParseOptions const& options = {}, std::string_view text = {}, std::pmr::memory_resource* arena = {});
+
+	~JsonBuilder() final;
 
-	[[nodiscard]] static auto make_error(Token token, Error::Type type) -> Error;
-	[[nodiscard]] auto make_error(Error::Type type) const -> Error;
+	JsonBuilder(JsonBuilder const&) = delete;
+	JsonBuilder(JsonBuilder&&) = delete;
+	auto operator=(JsonBuilder const&) -> JsonBuilder& = delete;
+	auto operator=(JsonBuilder&&) -> JsonBuilder& = delete;
 
-	[[nodiscard]] auto parse_value() -> Json;
+	[[nodiscard]] auto release() -> Json { return std::move(m_root); }
 
-	[[nodiscard]] auto from_operator(token::Operator op) -> Json;
+	void on_null() final;
+	void on_bool(bool value) final;
+	void on_number(ParsedNumber const& value) final;
+	void on_string(std::string_view value) final;
+
+	void on_key(std::string_view key) final;
+
+	void begin_array() final;
+	void end_array() final;
+	void begin_object() final;
+	void end_object() final;
+
+  private:
+	/// \brief Array / Object being built: its members are pending at the back of m_elements / m_members from first.
+	struct Frame {
+		std::size_t first{};
+		bool is_object{};
+	};
+
+	/// \brief Member of an Object being built, pushed with its key (and a null value) by on_key().
+	struct Member {
+		Key key{};
+		Json value{};
+	};
+
+	template <typename T, typename... Args>
+	[[nodiscard]] auto make_json(Args&&... args) const -> Json;
+
+	[[nodiscard]] auto get_resource() const -> std::pmr::memory_resource* { return m_arena != nullptr ? m_arena : std::pmr::get_default_resource(); }
+
+	void close();
+	void add(Json value);
+
+	StringFactory m_strings;
+	std::pmr::memory_resource* m_arena{};
+	bool m_raw_numbers{};
+	std::vector<Frame> m_stack{};
+	/// \brief Pending members of all open containers, moved into each once it is closed (and its size is known).
+	std::vector<Json> m_elements{};
+	std::vector<Member> m_members{};
+	Json m_root{};
+};
+
+/// \brief Push-based parser: consumes one token at a time, passing values to an EventHandler.
+/// Holds no view of the source text between tokens, so tokens may come from different buffers.
+class EventParser {
+  public:
 	template <typename T>
-	[[nodiscard]] auto make_number(token::Number in) -> Json;
-	[[nodiscard]] auto make_string(token::String in) -> Json;
+	using Expected = std::expected<T, ParseError>;
+	using Status = Expected<void>;
 
-	[[nodiscard]] auto iterate_unless(token::Operator op) -> bool;
-	[[nodiscard]] auto make_array() -> Json;
-	[[nodiscard]] auto make_object() -> Json;
+	explicit EventParser(EventHandler& handler, ParseOptions const& options);
 
-	[[nodiscard]] auto unescape_string(token::String in) const -> std::string;
-	[[nodiscard]] auto make_key() -> std::string;
+	/// \brief Consume the next token (including comments).
+	/// Errors for comments and Eof are final, others must only be reported once the following
+	/// non-comment token has been scanned successfully (scan errors take precedence).
+	[[nodiscard]] auto push(Token const& token) -> Status;
 
-	void check_jsonc_header();
+  private:
+	/// \brief Expected next token.
+	enum class State : std::int8_t {
+		Document,
+		Value,
+		FirstElement,
+		FirstMember,
+		Key,
+		Colon,
+		AfterValue,
+		AfterComma,
+		End,
+		Done,
+	};
+
+	/// \brief Open Array / Object and its number of elements / members so far.
+	struct Container {
+		token::Operator closer{};
+		std::uint64_t count{};
+	};
+
+	[[nodiscard]] auto handle_comment(Token const& token) -> Status;
+
+	[[nodiscard]] auto parse_value(Token const& token) -> Status;
+	[[nodiscard]] auto parse_key(Token const& token) -> Status;
+	[[nodiscard]] auto after_value(Token const& token) -> Status;
+	[[nodiscard]] auto after_comma(Token const& token) -> Status;
+
+	[[nodiscard]] auto from_operator(Token const& token, token::Operator op) -> Status;
+	[[nodiscard]] auto make_number(Token const& token, token::Number in) -> Status;
+	[[nodiscard]] auto make_string(Token const& token, token::String in) -> Status;
+
+	[[nodiscard]] auto open_container(Token const& token) -> Status;
+	void close_container();
+	void complete_value();
 
+	/// \brief Obtain a view of the unescaped string: into the source text if there are no escapes, else into m_buffer.
+	[[nodiscard]] auto unescape_string(Token const& token, token::String in) -> Expected<std::string_view>;
+
+	EventHandler* m_handler{};
 	ParseMode m_mode{ParseMode::Auto};
+	std::uint64_t m_max_depth{};
+	std::uint64_t m_max_string_length{};
+	std::uint64_t m_max_elements{};
+	std::uint64_t m_max_nodes{};
+	bool m_validate_utf8{};
+	bool m_raw_numbers{};
+
+	State m_state{State::Document};
+	bool m_first{true};
+	std::uint64_t m_nodes{};
+	/// \brief Open containers (explicit stack: nesting depth does not consume call stack).
+	std::vector<Container> m_containers{};
+	std::string m_buffer{};
+};
+
+/// \brief Parses complete JSON text by pushing its tokens into an EventParser.
+class Parser {
+  public:
+	[[nodiscard]] static auto make_json(Value::Payload payload) -> Json;
+	[[nodiscard]] static auto make_bool(bool const value) -> Json {
+		auto ret = Json{};
+		ret.store(Json::Kind::Bool, value);
+		return ret;
+	}
+	[[nodiscard]] static auto make_number(ParsedNumber::Payload const& payload) -> Json {
+		auto ret = Json{};
+		auto const visitor = Visitor{
+			[&ret](double const value) { ret.store(Json::Kind::F64, value); },
+			[&ret](std::uint64_t const value) { ret.store(Json::Kind::U64, value); },
+			[&ret](std::int64_t const value) { ret.store(Json::Kind::I64, value); },
+		};
+		std::visit(visitor, payload);
+		return ret;
+	}
+	/// \brief Store text inline in json if short enough.
+	/// \returns false if text is too long.
+	[[nodiscard]] static auto set_chars(Json& json, std::string_view const text) -> bool {
+		if (text.size() > Json::chars_capacity_v) { return false; }
+		json.set_chars(text);
+		return true;
+	}
+	/// \brief Store a view of text in json.
+	static void set_view(Json& json, std::string_view const text) { json.set_view(text); }
+	/// \brief Store a copy of text in json as a shared string, overwriting its own in place if unshared and large enough.
+	static void set_shared(Json& json, std::string_view const text) {
+		if (auto* shared = get_shared(json); shared != nullptr && shared->try_overwrite(text)) { return; }
+		json.store(Json::Kind::Shared, SharedString::make(text));
+	}
+	/// \brief Construct the payload in place, avoiding moves of non-trivial literals.
+	template <typename T, typename... Args>
+	[[nodiscard]] static auto make_json(std::in_place_type_t<T> type, Args&&... args) -> Json {
+		auto ret = Json{};
+		// NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+		ret.store(Json::Kind::Value, new Value{.payload = Value::Payload{type, std::forward<Args>(args)...}});
+		return ret;
+	}
+	/// \brief Allocate the Value from arena instead: it must never be destroyed, only abandoned (and released with the arena).
+	template <typename T, typename... Args>
+	[[nodiscard]] static auto make_json(std::pmr::memory_resource& arena, std::in_place_type_t<T> type, Args&&... args) -> Json {
+		auto ret = Json{};
+		auto* value = static_cast<Value*>(arena.allocate(sizeof(Value), alignof(Value)));
+		ret.store(Json::Kind::Value, ::new (value) Value{.payload = Value::Payload{type, std::forward<Args>(args)...}});
+		return ret;
+	}
+	/// \brief Reset json to null without destroying its Value (allocated from an arena).
+	static void abandon(Json& json);
+
+	/// \brief Obtain the Value of json, null if stored inline.
+	[[nodiscard]] static auto get_value(Json const& json) -> Value* { return json.get_value(); }
+	/// \brief Obtain the shared string of json, null if not one.
+	[[nodiscard]] static auto get_shared(Json const& json) -> SharedString* {
+		return json.m_kind == Json::Kind::Shared ? json.load<SharedString*>() : nullptr;
+	}
+	/// \brief Obtain the Value of json for writing, null if stored inline.
+	/// A shared Value is first replaced by a copy of it, which shares its members (if a container) in turn.
+	[[nodiscard]] static auto unshare(Json& json) -> Value*;
+	/// \brief Obtain the payload of json as T (for writing), replacing its value with a default T if not one.
+	template <typename T>
+	[[nodiscard]] static auto morph(Json& json) -> T& {
+		if (auto* value = unshare(json)) { return value->morph<T>(); }
+		json = make_json(std::in_place_type<T>);
+		return std::get<T>(json.get_value()->payload);
+	}
+	/// \brief Obtain the payload of json as T (for handing out mutable references to its members), pinning its Value.
+	template <typename T>
+	[[nodiscard]] static auto pin(Json& json) -> T& {
+		auto& ret = morph<T>(json);
+		json.get_value()->pinned = true;
+		return ret;
+	}
+
+	/// \brief Parse a large top-level Array / Object by splitting it into ranges of elements, parsed on multiple threads.
+	/// \returns Json if successful, else nullopt: the text must then be parsed serially (including to report errors).
+	[[nodiscard]] static auto parse_parallel(std::string_view text, ParseOptions const& options) -> std::optional<Json>;
+
+	explicit Parser(std::string_view text, ParseOptions const& options);
+	explicit Parser(std::string_view text, ParseMode mode);
+
+	/// \brief Parse text into a Json.
+	[[nodiscard]] auto parse() -> Result;
+	/// \brief Parse text into target, reusing its Values, capacity and buffers.
+	[[nodiscard]] auto parse_into(Json& target) -> std::expected<void, Error>;
+	/// \brief Parse text, passing values to handler.
+	[[nodiscard]] auto parse(EventHandler& handler) -> std::expected<void, Error>;
 
+  private:
+	[[nodiscard]] auto to_error(ParseError const& error) const -> Error;
+
+	ParseOptions m_options{};
+	std::string_view m_text{};
 	Scanner m_scanner;
-	Token m_current{};
-	Token m_next{};
 };
+
+template <typename T, typename... Args>
+auto JsonBuilder::make_json(Args&&... args) const -> Json {
+	if (m_arena != nullptr) { return Parser::make_json(*m_arena, std::in_place_type<T>, std::forward<Args>(args)...); }
+	return Parser::make_json(std::in_place_type<T>, std::forward<Args>(args)...);
+}
 } // namespace dj::detail
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace dj::detail {
+#if defined(DJ_NONATOMIC_REFCOUNT)
+inline constexpr bool atomic_refcount_v{false};
+#else
+inline constexpr bool atomic_refcount_v{true};
+#endif
+
+/// \brief Intrusive reference count, starting at 1 (the creator's reference).
+/// \tparam Atomic Whether the count is atomic: references may then be taken and dropped on any thread.
+template <bool Atomic>
+class BasicRefCount {
+  public:
+	BasicRefCount() = default;
+	~BasicRefCount() = default;
+
+	BasicRefCount(BasicRefCount const&) = delete;
+	BasicRefCount(BasicRefCount&&) = delete;
+	auto operator=(BasicRefCount const&) -> BasicRefCount& = delete;
+	auto operator=(BasicRefCount&&) -> BasicRefCount& = delete;
+
+	void retain() {
+		if constexpr (Atomic) {
+			m_count.fetch_add(1, std::memory_order_relaxed);
+		} else {
+			++m_count;
+		}
+	}
+
+	/// \returns true if this was the last reference.
+	[[nodiscard]] auto release() -> bool {
+		if constexpr (Atomic) {
+			return m_count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+		} else {
+			return --m_count == 0;
+		}
+	}
+
+	/// \brief Whether the caller holds the only reference: writes by previous holders are then visible.
+	[[nodiscard]] auto is_unique() const -> bool {
+		if constexpr (Atomic) {
+			return m_count.load(std::memory_order_acquire) == 1;
+		} else {
+			return m_count == 1;
+		}
+	}
+
+  private:
+	using Count = std::conditional_t<Atomic, std::atomic<std::size_t>, std::size_t>;
+
+	Count m_count{1};
+};
+
+using RefCount = BasicRefCount<atomic_refcount_v>;
+} // namespace dj::detail
@@ -1,10 +1,11 @@
 #pragma once
+#include <detail/char_class.hpp>
+#include <detail/simd.hpp>
 #include <detail/token.hpp>
+#include <djson/src_loc.hpp>
 #include <algorithm>
-#include <array>
 #include <cassert>
 #include <expected>
-#include <ranges>
 
 namespace dj::detail {
 struct ScanError {
@@ -16,46 +17,39 @@ struct ScanError {
 
 	Type type{};
 	std::string_view token{};
-	SrcLoc src_loc{};
+	std::uint64_t offset{};
 };
 
-class Scanner {
-	[[nodiscard]] static constexpr auto is_space(char const c) -> bool {
-		constexpr auto chars_v = std::array{' ', '\t', '\n', '\r'};
-		return std::ranges::find(chars_v, c) != chars_v.end();
-	}
-
-	[[nodiscard]] static constexpr auto is_digit(char const c) -> bool { return c >= '0' && c <= '9'; }
+/// \brief Compute the line and column of a byte offset into text.
+/// Only intended for error paths: cost is linear in offset.
+[[nodiscard]] constexpr auto to_src_loc(std::string_view const text, std::uint64_t const offset) -> SrcLoc {
+	auto const prefix = text.substr(0, offset);
+	auto const line_start = prefix.rfind('\n');
+	return SrcLoc{
+		.line = std::uint64_t(std::ranges::count(prefix, '\n')) + 1,
+		.column = line_start == std::string_view::npos ? prefix.size() + 1 : prefix.size() - line_start,
+	};
+}
 
-	[[nodiscard]] static constexpr auto is_part_number(char const c) -> bool {
-		constexpr auto chars_v = std::array{'.', 'e', 'E', '-', '+'};
-		return is_digit(c) || std::ranges::find(chars_v, c) != chars_v.end();
-	}
+class Scanner {
+	[[nodiscard]] constexpr auto get_offset() const -> std::uint64_t { return m_text.size() - m_remain.size(); }
 
-	constexpr void advance() {
-		assert(!m_remain.empty());
-		if (m_remain.front() == '\n') {
-			++m_src_loc.line;
-			m_src_loc.column = 1;
-		} else {
-			++m_src_loc.column;
-		}
-		m_remain.remove_prefix(1);
+	constexpr void advance(std::size_t const length) {
+		assert(length <= m_remain.size());
+		m_remain.remove_prefix(length);
 	}
 
-	constexpr void trim_front() {
-		while (!m_remain.empty() && is_space(m_remain.front())) { advance(); }
-	}
+	constexpr void trim_front() { advance(simd::skip_whitespace(m_remain)); }
 
 	template <typename T>
 	[[nodiscard]] constexpr auto to_token(T const type, std::uint64_t const length) -> Token {
 		auto const ret = Token{
 			.type = type,
 			.lexeme = m_remain.substr(0, length),
-			.src_loc = m_src_loc,
+			.offset = get_offset(),
 		};
 		if (length > 0) {
-			for (std::uint64_t i = 0; i < length; ++i) { advance(); }
+			advance(length);
 			trim_front();
 		}
 		return ret;
@@ -65,45 +59,29 @@ class Scanner {
 		return ScanError{
 			.type = type,
 			.token = m_remain.substr(0, length),
-			.src_loc = m_src_loc,
+			.offset = get_offset(),
 		};
 	}
 
-	[[nodiscard]] constexpr auto try_operator(Token& out) -> bool {
-		for (auto const [index, op_str] : std::views::enumerate(token::operator_str_v)) {
-			if (!m_remain.starts_with(op_str)) { continue; }
-			out = to_token(token::Operator(index), op_str.size());
-			return true;
-		}
-		return false;
+	[[nodiscard]] constexpr auto try_keyword(token::Operator const op, Token& out) -> bool {
+		auto const keyword = token::operator_str_v.at(std::size_t(op));
+		if (!m_remain.starts_with(keyword)) { return false; }
+		out = to_token(op, keyword.size());
+		return true;
 	}
 
-	[[nodiscard]] constexpr auto try_number(Token& out) -> bool {
-		if (m_remain.front() != '-' && !is_digit(m_remain.front())) { return false; }
+	[[nodiscard]] constexpr auto scan_number() -> Token {
 		auto index = 1uz;
-		for (; index < m_remain.size() && is_part_number(m_remain.at(index)); ++index) {}
-		auto const length = index;
-		out = to_token(token::Number{.raw_str = m_remain.substr(0, length)}, length);
-		return true;
+		for (; index < m_remain.size() && is_part_number(m_remain[index]); ++index) {}
+		return to_token(token::Number{.raw_str = m_remain.substr(0, index)}, index);
 	}
 
 	[[nodiscard]] constexpr auto scan_string() -> std::expected<Token, ScanError> {
 		assert(m_remain.starts_with("\""));
-		auto escaped = false;
-		auto index = 1uz;
-		for (; index < m_remain.size(); ++index) {
-			if (escaped) {
-				escaped = false;
-				continue;
-			}
-			char const ch = m_remain.at(index);
-			if (ch == '\\') {
-				escaped = true;
-				continue;
-			}
-			if (ch == '\"') { break; }
-		}
-		if (index == m_remain.size()) { return std::unexpected(to_scan_error(ScanError::Type::MissingClosingQuote, 1)); }
+		auto index = simd::find_quote_or_backslash(m_remain, 1);
+		// skip escaped characters: the one following a backslash can never terminate the string.
+		while (index < m_remain.size() && m_remain[index] == '\\') { index = simd::find_quote_or_backslash(m_remain, index + 2); }
+		if (index >= m_remain.size()) { return std::unexpected(to_scan_error(ScanError::Type::MissingClosingQuote, 1)); }
 
 		auto const length = index - 1;
 		return to_token(token::String{.escaped = m_remain.substr(1, length)}, length + 2);
@@ -125,25 +103,36 @@ class Scanner {
 		return to_token(token::Comment{.text = m_remain.substr(0, length)}, length);
 	}
 
+	std::string_view m_text{};
 	std::string_view m_remain{};
-	SrcLoc m_src_loc{};
 
   public:
-	explicit constexpr Scanner(std::string_view const text) : m_remain(text) {
-		trim_front();
-		if (!m_remain.empty()) { m_src_loc = {.line = 1, .column = 1}; }
-	}
+	explicit constexpr Scanner(std::string_view const text) : m_text(text), m_remain(text) { trim_front(); }
+
+	[[nodiscard]] constexpr auto get_text() const -> std::string_view { return m_text; }
+
+	[[nodiscard]] constexpr auto get_src_loc(std::uint64_t const offset) const -> SrcLoc { return to_src_loc(m_text, offset); }
 
 	[[nodiscard]] constexpr auto next() -> std::expected<Token, ScanError> {
 		if (m_remain.empty()) { return to_token(token::Eof{}, 0); }
 
-		auto ret = Token{.src_loc = m_src_loc};
-
-		if (try_operator(ret)) { return ret; }
-		if (try_number(ret)) { return ret; }
-		if (m_remain.starts_with("\"")) { return scan_string(); }
-		if (m_remain.starts_with("//")) { return scan_line_comment(); }
-		if (m_remain.starts_with("/*")) { return scan_multiline_comment(); }
+		auto const& char_class = get_char_class(m_remain.front());
+		switch (char_class.lead) {
+		case Lead::Operator: return to_token(char_class.op, 1);
+		case Lead::Keyword: {
+			auto ret = Token{};
+			if (try_keyword(char_class.op, ret)) { return ret; }
+			break;
+		}
+		case Lead::Number: return scan_number();
+		case Lead::Quote: return scan_string();
+		case Lead::Slash: {
+			if (m_remain.starts_with("//")) { return scan_line_comment(); }
+			if (m_remain.starts_with("/*")) { return scan_multiline_comment(); }
+			break;
+		}
+		default: break;
+		}
 
 		return std::unexpected(to_scan_error(ScanError::Type::UnrecognizedToken, 1));
 	}
@@ -0,0 +1,64 @@
+#pragma once
+#include <detail/ref_count.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <string_view>
+
+namespace dj::detail {
+/// \brief Immutable string with an intrusive reference count, allocated together with its text.
+/// Copies share the allocation: retain() / release() instead of copying the text.
+/// \tparam Atomic Whether the count is atomic: copies (and releases) may then happen on any thread.
+template <bool Atomic>
+class BasicSharedString {
+  public:
+	BasicSharedString(BasicSharedString const&) = delete;
+	BasicSharedString(BasicSharedString&&) = delete;
+	auto operator=(BasicSharedString const&) -> BasicSharedString& = delete;
+	auto operator=(BasicSharedString&&) -> BasicSharedString& = delete;
+
+	/// \brief Allocate a copy of text with a count of 1.
+	[[nodiscard]] static auto make(std::string_view const text) -> BasicSharedString* {
+		auto* storage = ::operator new(sizeof(BasicSharedString) + text.size());
+		auto* ret = ::new (storage) BasicSharedString{text.size()};
+		std::ranges::copy(text, ret->get_data());
+		return ret;
+	}
+
+	static void retain(BasicSharedString* const string) { string->m_count.retain(); }
+
+	/// \brief Decrement the count, freeing the string if it was the last reference.
+	static void release(BasicSharedString* const string) noexcept {
+		if (!string->m_count.release()) { return; }
+		string->~BasicSharedString();
+		::operator delete(string);
+	}
+
+	[[nodiscard]] auto get_text() const -> std::string_view { return std::string_view{get_data(), m_size}; }
+
+	[[nodiscard]] auto is_unique() const -> bool { return m_count.is_unique(); }
+
+	/// \brief Overwrite the text in place, only if this is the sole reference and text fits in the allocation.
+	/// \returns true if overwritten.
+	[[nodiscard]] auto try_overwrite(std::string_view const text) -> bool {
+		if (text.size() > m_capacity || !is_unique()) { return false; }
+		std::ranges::copy(text, get_data());
+		m_size = text.size();
+		return true;
+	}
+
+  private:
+	explicit BasicSharedString(std::size_t const size) : m_size(size), m_capacity(size) {}
+	~BasicSharedString() = default;
+
+	// text follows the header in the same allocation.
+	[[nodiscard]] auto get_data() -> char* { return reinterpret_cast<char*>(this + 1); } // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	[[nodiscard]] auto get_data() const -> char const* { return reinterpret_cast<char const*>(this + 1); } // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+	BasicRefCount<Atomic> m_count{};
+	std::size_t m_size{};
+	std::size_t m_capacity{};
+};
+
+using SharedString = BasicSharedString<atomic_refcount_v>;
+} // namespace dj::detail
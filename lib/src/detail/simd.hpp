@@ -0,0 +1,196 @@
+#pragma once
+#include <detail/char_class.hpp>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DJ_SIMD_SSE2
+#endif
+
+namespace dj::detail::simd {
+namespace scalar {
+[[nodiscard]] constexpr auto skip_whitespace(std::string_view const text, std::size_t index = 0) -> std::size_t {
+	for (; index < text.size() && is_space(text[index]); ++index) {}
+	return index;
+}
+
+[[nodiscard]] constexpr auto find_quote_or_backslash(std::string_view const text, std::size_t const index = 0) -> std::size_t {
+	auto const ret = text.find_first_of(R"("\)", index);
+	return ret == std::string_view::npos ? text.size() : ret;
+}
+
+[[nodiscard]] constexpr auto find_backslash(std::string_view const text, std::size_t const index = 0) -> std::size_t {
+	auto const ret = text.find('\\', index);
+	return ret == std::string_view::npos ? text.size() : ret;
+}
+
+[[nodiscard]] constexpr auto find_non_ascii(std::string_view const text, std::size_t index = 0) -> std::size_t {
+	for (; index < text.size() && static_cast<unsigned char>(text[index]) < 0x80; ++index) {}
+	return index;
+}
+} // namespace scalar
+
+namespace swar {
+using Word = std::uint64_t;
+
+inline constexpr auto ones_v = Word{0x0101010101010101};
+inline constexpr auto low7_v = Word{0x7f7f7f7f7f7f7f7f};
+inline constexpr auto high_v = Word{0x8080808080808080};
+
+[[nodiscard]] inline auto load(char const* ptr) -> Word {
+	auto ret = Word{};
+	std::memcpy(&ret, ptr, sizeof(ret));
+	return ret;
+}
+
+// exact (no false positives): sets the high bit of every byte in word equal to c.
+[[nodiscard]] constexpr auto match(Word const word, char const c) -> Word {
+	auto const x = word ^ (ones_v * static_cast<unsigned char>(c));
+	return ~(((x & low7_v) + low7_v) | x | low7_v);
+}
+
+[[nodiscard]] constexpr auto first_byte(Word const mask) -> std::size_t { return std::size_t(std::countr_zero(mask)) / 8; }
+} // namespace swar
+
+#if defined(DJ_SIMD_SSE2)
+namespace sse2 {
+inline constexpr auto width_v = sizeof(__m128i);
+
+[[nodiscard]] inline auto load(char const* ptr) -> __m128i { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(ptr)); } // NOLINT
+
+[[nodiscard]] inline auto match(__m128i const block, char const c) -> __m128i { return _mm_cmpeq_epi8(block, _mm_set1_epi8(c)); }
+
+[[nodiscard]] inline auto to_mask(__m128i const block) -> std::uint32_t { return static_cast<std::uint32_t>(_mm_movemask_epi8(block)); }
+} // namespace sse2
+#endif
+
+[[nodiscard]] inline auto skip_whitespace_blocks(std::string_view const text, std::size_t index) -> std::size_t {
+	auto const* data = text.data();
+#if defined(DJ_SIMD_SSE2)
+	for (; index + sse2::width_v <= text.size(); index += sse2::width_v) {
+		auto const block = sse2::load(data + index); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		auto const spaces = _mm_or_si128(_mm_or_si128(sse2::match(block, ' '), sse2::match(block, '\t')),
+										 _mm_or_si128(sse2::match(block, '\n'), sse2::match(block, '\r')));
+		auto const mask = ~sse2::to_mask(spaces) & 0xffffu;
+		if (mask != 0) { return index + std::size_t(std::countr_zero(mask)); }
+	}
+#else
+	if constexpr (std::endian::native == std::endian::little) {
+		for (; index + sizeof(swar::Word) <= text.size(); index += sizeof(swar::Word)) {
+			auto const word = swar::load(data + index); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			auto const spaces = swar::match(word, ' ') | swar::match(word, '\t') | swar::match(word, '\n') | swar::match(word, '\r');
+			auto const mask = ~spaces & swar::high_v;
+			if (mask != 0) { return index + swar::first_byte(mask); }
+		}
+	}
+#endif
+	return scalar::skip_whitespace(text, index);
+}
+
+[[nodiscard]] inline auto find_quote_or_backslash_blocks(std::string_view const text, std::size_t index) -> std::size_t {
+	auto const* data = text.data();
+#if defined(DJ_SIMD_SSE2)
+	for (; index + sse2::width_v <= text.size(); index += sse2::width_v) {
+		auto const block = sse2::load(data + index); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		auto const mask = sse2::to_mask(_mm_or_si128(sse2::match(block, '"'), sse2::match(block, '\\')));
+		if (mask != 0) { return index + std::size_t(std::countr_zero(mask)); }
+	}
+#else
+	if constexpr (std::endian::native == std::endian::little) {
+		for (; index + sizeof(swar::Word) <= text.size(); index += sizeof(swar::Word)) {
+			auto const word = swar::load(data + index); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			auto const mask = swar::match(word, '"') | swar::match(word, '\\');
+			if (mask != 0) { return index + swar::first_byte(mask); }
+		}
+	}
+#endif
+	return scalar::find_quote_or_backslash(text, index);
+}
+
+[[nodiscard]] inline auto find_backslash_blocks(std::string_view const text, std::size_t index) -> std::size_t {
+	auto const* data = text.data();
+#if defined(DJ_SIMD_SSE2)
+	for (; index + sse2::width_v <= text.size(); index += sse2::width_v) {
+		auto const block = sse2::load(data + index); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		auto const mask = sse2::to_mask(sse2::match(block, '\\'));
+		if (mask != 0) { return index + std::size_t(std::countr_zero(mask)); }
+	}
+#else
+	if constexpr (std::endian::native == std::endian::little) {
+		for (; index + sizeof(swar::Word) <= text.size(); index += sizeof(swar::Word)) {
+			auto const word = swar::load(data + index); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			auto const mask = swar::match(word, '\\');
+			if (mask != 0) { return index + swar::first_byte(mask); }
+		}
+	}
+#endif
+	return scalar::find_backslash(text, index);
+}
+
+[[nodiscard]] inline auto find_non_ascii_blocks(std::string_view const text, std::size_t index) -> std::size_t {
+	auto const* data = text.data();
+#if defined(DJ_SIMD_SSE2)
+	for (; index + sse2::width_v <= text.size(); index += sse2::width_v) {
+		// the mask is formed from the high bit of each byte.
+		auto const mask = sse2::to_mask(sse2::load(data + index)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		if (mask != 0) { return index + std::size_t(std::countr_zero(mask)); }
+	}
+	// the remainder is loaded as the last block of text, which may begin before index: those bytes are shifted out of the mask.
+	if (index < text.size() && text.size() >= sse2::width_v) {
+		auto const start = text.size() - sse2::width_v;
+		auto const mask = sse2::to_mask(sse2::load(data + start)) >> (index - start); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		return mask == 0 ? text.size() : index + std::size_t(std::countr_zero(mask));
+	}
+#else
+	if constexpr (std::endian::native == std::endian::little) {
+		for (; index + sizeof(swar::Word) <= text.size(); index += sizeof(swar::Word)) {
+			auto const mask = swar::load(data + index) & swar::high_v; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			if (mask != 0) { return index + swar::first_byte(mask); }
+		}
+	}
+#endif
+	return scalar::find_non_ascii(text, index);
+}
+
+/// \brief Obtain the index of the first non-whitespace character at or after index (or text.size()).
+[[nodiscard]] constexpr auto skip_whitespace(std::string_view const text, std::size_t const index = 0) -> std::size_t {
+	if consteval {
+		return scalar::skip_whitespace(text, index);
+	} else {
+		// most tokens are separated by at most a single space: avoid block setup for those.
+		if (index >= text.size() || !is_space(text[index])) { return index; }
+		if (index + 1 >= text.size() || !is_space(text[index + 1])) { return index + 1; }
+		return skip_whitespace_blocks(text, index + 2);
+	}
+}
+
+/// \brief Obtain the index of the first '"' or '\' at or after index (or text.size()).
+[[nodiscard]] constexpr auto find_quote_or_backslash(std::string_view const text, std::size_t const index = 0) -> std::size_t {
+	if consteval {
+		return scalar::find_quote_or_backslash(text, index);
+	} else {
+		return find_quote_or_backslash_blocks(text, index);
+	}
+}
+
+/// \brief Obtain the index of the first '\' at or after index (or text.size()).
+[[nodiscard]] constexpr auto find_backslash(std::string_view const text, std::size_t const index = 0) -> std::size_t {
+	if consteval {
+		return scalar::find_backslash(text, index);
+	} else {
+		return find_backslash_blocks(text, index);
+	}
+}
+
+/// \brief Obtain the index of the first non-ASCII byte (>= 0x80) at or after index (or text.size()).
+[[nodiscard]] constexpr auto find_non_ascii(std::string_view const text, std::size_t const index = 0) -> std::size_t {
+	if consteval {
+		return scalar::find_non_ascii(text, index);
+	} else {
+		return find_non_ascii_blocks(text, index);
+	}
+}
+} // namespace dj::detail::simd
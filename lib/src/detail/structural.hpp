@@ -0,0 +1,57 @@
+#pragma once
+#include <detail/simd.hpp>
+#include <optional>
+#include <string_view>
+
+namespace dj::detail {
+/// \brief Find the end of a container by bracket matching, without tokenizing its contents.
+/// Strings and comments are stepped over, nothing else is validated.
+/// \param text Source text.
+/// \param index Index one past the opening bracket.
+/// \param on_separator Invoked with the index of each ',' at the top level of the container.
+/// \returns Index one past the matching closing bracket.
+template <typename OnSeparator>
+[[nodiscard]] auto scan_container(std::string_view const text, std::size_t index, OnSeparator on_separator) -> std::optional<std::size_t> {
+	for (auto depth = 1uz; index < text.size(); ++index) {
+		switch (text[index]) {
+		case '[':
+		case '{': ++depth; break;
+		case ']':
+		case '}': {
+			if (--depth == 0) { return index + 1; }
+			break;
+		}
+		case ',': {
+			if (depth == 1) { on_separator(index); }
+			break;
+		}
+		case '"': {
+			index = simd::find_quote_or_backslash(text, index + 1);
+			while (index < text.size() && text[index] == '\\') { index = simd::find_quote_or_backslash(text, index + 2); }
+			break;
+		}
+		case '/': {
+			auto const remain = text.substr(index);
+			if (remain.starts_with("//")) {
+				index = text.find('\n', index);
+			} else if (remain.starts_with("/*")) {
+				index = text.find("*/", index + 2);
+				if (index != std::string_view::npos) { ++index; }
+			}
+			break;
+		}
+		default: break;
+		}
+		if (index >= text.size()) { break; }
+	}
+	return {};
+}
+
+/// \brief Find the end of a container by bracket matching, without tokenizing its contents.
+/// \param text Source text.
+/// \param index Index one past the opening bracket.
+/// \returns Index one past the matching closing bracket.
+[[nodiscard]] inline auto skip_container(std::string_view const text, std::size_t const index) -> std::optional<std::size_t> {
+	return scan_container(text, index, [](std::size_t) {});
+}
+} // namespace dj::detail
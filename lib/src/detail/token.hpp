@@ -1,7 +1,7 @@
 #pragma once
-#include <djson/src_loc.hpp>
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <string_view>
 #include <variant>
 
@@ -45,6 +45,7 @@ struct Token {
 
 	Type type{token::Eof{}};
 	std::string_view lexeme{};
-	SrcLoc src_loc{};
+	/// \brief Byte offset of lexeme in the source text.
+	std::uint64_t offset{};
 };
 } // namespace dj::detail
@@ -0,0 +1,114 @@
+#pragma once
+#include <detail/simd.hpp>
+#include <detail/token.hpp>
+#include <djson/error.hpp>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace dj::detail {
+struct Unescape {
+	[[nodiscard]] auto operator()(std::string& out) const -> std::optional<Error::Type> {
+		auto const text = in.escaped;
+		out.reserve(out.size() + text.size());
+		auto index = 0uz;
+		while (index < text.size()) {
+			// bulk copy the run up to the next escape sequence.
+			auto const backslash = simd::find_backslash(text, index);
+			out.append(text.substr(index, backslash - index));
+			if (backslash >= text.size()) { break; }
+
+			if (backslash + 1 >= text.size()) { return Error::Type::InvalidEscape; }
+			auto const escaped = text[backslash + 1];
+			if (escaped == 'u') {
+				auto const length = unescape_unicode(out, text.substr(backslash));
+				if (length == 0) { return Error::Type::InvalidEscape; }
+				index = backslash + length;
+				continue;
+			}
+			if (!unescape(out, escaped)) { return Error::Type::InvalidEscape; }
+			index = backslash + 2;
+		}
+		return {};
+	}
+
+	[[nodiscard]] static auto unescape(std::string& out, char const escaped) -> bool {
+		switch (escaped) {
+		case '\"': out.push_back('\"'); return true;
+		case '\\': out.push_back('\\'); return true;
+		case '/': out.push_back('/'); return true;
+		case 'b': out.push_back('\b'); return true;
+		case 'f': out.push_back('\f'); return true;
+		case 'n': out.push_back('\n'); return true;
+		case 'r': out.push_back('\r'); return true;
+		case 't': out.push_back('\t'); return true;
+		default: return false;
+		}
+	}
+
+	/// \brief Decode a \uXXXX escape sequence (or a surrogate pair of them) at the start of text into UTF-8.
+	/// \returns Length of the decoded escape sequence(s), 0 if invalid.
+	[[nodiscard]] static auto unescape_unicode(std::string& out, std::string_view const text) -> std::size_t {
+		auto code_point = to_code_unit(text);
+		if (!code_point) { return 0; }
+		auto length = code_unit_length_v;
+
+		if (is_low_surrogate(*code_point)) { return 0; }
+		if (is_high_surrogate(*code_point)) {
+			auto const low = to_code_unit(text.substr(length));
+			if (!low || !is_low_surrogate(*low)) { return 0; }
+			code_point = 0x10000 + ((*code_point - 0xd800) << 10) + (*low - 0xdc00);
+			length += code_unit_length_v;
+		}
+
+		append_utf8(out, *code_point);
+		return length;
+	}
+
+	token::String in{};
+
+  private:
+	/// \brief Length of a \uXXXX escape sequence.
+	static constexpr auto code_unit_length_v = 6uz;
+
+	[[nodiscard]] static constexpr auto is_high_surrogate(std::uint32_t const code_unit) -> bool { return code_unit >= 0xd800 && code_unit < 0xdc00; }
+	[[nodiscard]] static constexpr auto is_low_surrogate(std::uint32_t const code_unit) -> bool { return code_unit >= 0xdc00 && code_unit < 0xe000; }
+
+	[[nodiscard]] static constexpr auto to_code_unit(std::string_view const text) -> std::optional<std::uint32_t> {
+		if (text.size() < code_unit_length_v || !text.starts_with("\\u")) { return {}; }
+		auto ret = std::uint32_t{};
+		for (char const c : text.substr(2, 4)) {
+			ret <<= 4;
+			if (c >= '0' && c <= '9') {
+				ret |= std::uint32_t(c - '0');
+			} else if (c >= 'a' && c <= 'f') {
+				ret |= std::uint32_t(c - 'a' + 10);
+			} else if (c >= 'A' && c <= 'F') {
+				ret |= std::uint32_t(c - 'A' + 10);
+			} else {
+				return {};
+			}
+		}
+		return ret;
+	}
+
+	static void append_utf8(std::string& out, std::uint32_t const code_point) {
+		auto const append = [&out](std::uint32_t const byte) { out.push_back(static_cast<char>(byte)); };
+		if (code_point < 0x80) {
+			append(code_point);
+		} else if (code_point < 0x800) {
+			append(0xc0 | (code_point >> 6));
+			append(0x80 | (code_point & 0x3f));
+		} else if (code_point < 0x10000) {
+			append(0xe0 | (code_point >> 12));
+			append(0x80 | ((code_point >> 6) & 0x3f));
+			append(0x80 | (code_point & 0x3f));
+		} else {
+			append(0xf0 | (code_point >> 18));
+			append(0x80 | ((code_point >> 12) & 0x3f));
+			append(0x80 | ((code_point >> 6) & 0x3f));
+			append(0x80 | (code_point & 0x3f));
+		}
+	}
+};
+} // namespace dj::detail
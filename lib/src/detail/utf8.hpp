@@ -0,0 +1,131 @@
+#pragma once
+#include <detail/simd.hpp>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace dj::detail::utf8 {
+namespace scalar {
+/// \brief Obtain the length of the well-formed (RFC 3629) multi-byte sequence at index.
+/// \returns Length of the sequence, 0 if ill-formed (overlong, surrogate, out of range, truncated).
+[[nodiscard]] constexpr auto sequence_length(std::string_view const text, std::size_t const index) -> std::size_t {
+	auto const byte = [text, index](std::size_t const offset) { return static_cast<std::uint8_t>(text[index + offset]); };
+	auto const is_continuation = [&byte](std::size_t const offset) { return (byte(offset) & 0xc0) == 0x80; };
+	auto const remain = text.size() - index;
+	auto const lead = byte(0);
+	if (lead < 0xc2) { return 0; }
+	if (lead < 0xe0) { return remain >= 2 && is_continuation(1) ? 2 : 0; }
+
+	// valid range of the second byte, which excludes overlong forms, surrogates and code points beyond U+10FFFF.
+	auto low = std::uint8_t{0x80};
+	auto high = std::uint8_t{0xbf};
+	if (lead < 0xf0) {
+		if (lead == 0xe0) { low = 0xa0; }
+		if (lead == 0xed) { high = 0x9f; }
+		if (remain < 3 || byte(1) < low || byte(1) > high || !is_continuation(2)) { return 0; }
+		return 3;
+	}
+	if (lead > 0xf4) { return 0; }
+	if (lead == 0xf0) { low = 0x90; }
+	if (lead == 0xf4) { high = 0x8f; }
+	if (remain < 4 || byte(1) < low || byte(1) > high || !is_continuation(2) || !is_continuation(3)) { return 0; }
+	return 4;
+}
+
+[[nodiscard]] constexpr auto is_valid(std::string_view const text, std::size_t index) -> bool {
+	for (; index < text.size(); index = simd::find_non_ascii(text, index)) {
+		auto const length = sequence_length(text, index);
+		if (length == 0) { return false; }
+		index += length;
+	}
+	return true;
+}
+} // namespace scalar
+
+#if defined(DJ_SIMD_SSE2)
+namespace sse2 {
+using simd::sse2::width_v;
+
+/// \brief Validates consecutive blocks of text, accumulating errors.
+/// Checks each byte against the lead bytes preceding it (carried across blocks), without lookup tables.
+class Validator {
+  public:
+	void check(__m128i const block) {
+		// nothing can be pending from an ASCII block.
+		if (simd::sse2::to_mask(_mm_or_si128(block, m_previous)) == 0) { return; }
+
+		auto const prev1 = shift_in<1>(block);
+		auto const prev2 = shift_in<2>(block);
+		auto const prev3 = shift_in<3>(block);
+
+		// continuation bytes must be exactly those claimed by preceding lead bytes.
+		auto const is_continuation = _mm_andnot_si128(ge(block, 0xc0), ge(block, 0x80));
+		auto const expected = _mm_or_si128(_mm_or_si128(ge(prev1, 0xc0), ge(prev2, 0xe0)), ge(prev3, 0xf0));
+		auto errors = _mm_xor_si128(is_continuation, expected);
+
+		// overlong two byte sequences, and code points beyond U+10FFFF.
+		errors = _mm_or_si128(errors, _mm_or_si128(_mm_and_si128(le(block, 0xc1), ge(block, 0xc0)), ge(block, 0xf5)));
+		// second byte ranges: overlong three / four byte sequences, surrogates, code points beyond U+10FFFF.
+		errors = _mm_or_si128(errors, _mm_andnot_si128(ge(block, 0xa0), eq(prev1, 0xe0)));
+		errors = _mm_or_si128(errors, _mm_andnot_si128(le(block, 0x9f), eq(prev1, 0xed)));
+		errors = _mm_or_si128(errors, _mm_andnot_si128(ge(block, 0x90), eq(prev1, 0xf0)));
+		errors = _mm_or_si128(errors, _mm_andnot_si128(le(block, 0x8f), eq(prev1, 0xf4)));
+
+		m_errors = _mm_or_si128(m_errors, errors);
+		m_previous = block;
+	}
+
+	/// \brief Check for sequences truncated by the end of text, and obtain the result.
+	[[nodiscard]] auto finish() -> bool {
+		check(_mm_setzero_si128());
+		return simd::sse2::to_mask(m_errors) == 0;
+	}
+
+  private:
+	[[nodiscard]] static auto splat(std::uint8_t const byte) -> __m128i { return _mm_set1_epi8(static_cast<char>(byte)); }
+	[[nodiscard]] static auto eq(__m128i const block, std::uint8_t const byte) -> __m128i { return _mm_cmpeq_epi8(block, splat(byte)); }
+	// unsigned comparisons.
+	[[nodiscard]] static auto ge(__m128i const block, std::uint8_t const byte) -> __m128i { return _mm_cmpeq_epi8(_mm_max_epu8(block, splat(byte)), block); }
+	[[nodiscard]] static auto le(__m128i const block, std::uint8_t const byte) -> __m128i { return _mm_cmpeq_epi8(_mm_min_epu8(block, splat(byte)), block); }
+
+	/// \brief Obtain block with each byte replaced by the one Count bytes before it, carried over from the previous block.
+	template <int Count>
+	[[nodiscard]] auto shift_in(__m128i const block) const -> __m128i {
+		return _mm_or_si128(_mm_slli_si128(block, Count), _mm_srli_si128(m_previous, int(width_v) - Count));
+	}
+
+	__m128i m_previous{_mm_setzero_si128()};
+	__m128i m_errors{_mm_setzero_si128()};
+};
+
+[[nodiscard]] inline auto is_valid(std::string_view const text, std::size_t index) -> bool {
+	auto validator = Validator{};
+	for (; index + width_v <= text.size(); index += width_v) {
+		validator.check(simd::sse2::load(text.data() + index)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+	// zero (ASCII) padding.
+	auto tail = std::array<char, width_v>{};
+	std::memcpy(tail.data(), text.data() + index, text.size() - index); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	validator.check(simd::sse2::load(tail.data()));
+	return validator.finish();
+}
+} // namespace sse2
+#endif
+
+/// \brief Check whether text is well-formed UTF-8.
+[[nodiscard]] constexpr auto is_valid(std::string_view const text) -> bool {
+	// most text is entirely ASCII.
+	auto const index = simd::find_non_ascii(text);
+	if (index == text.size()) { return true; }
+	if consteval {
+		return scalar::is_valid(text, index);
+	} else {
+#if defined(DJ_SIMD_SSE2)
+		return sse2::is_valid(text, index);
+#else
+		return scalar::is_valid(text, index);
+#endif
+	}
+}
+} // namespace dj::detail::utf8
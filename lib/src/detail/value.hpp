@@ -1,38 +1,72 @@
 #pragma once
+#include <detail/ref_count.hpp>
+#include <djson/events.hpp>
 #include <djson/json.hpp>
-#include <djson/string_table.hpp>
+#include <djson/key_map.hpp>
+#include <atomic>
 #include <cstdint>
+#include <memory_resource>
 #include <string>
 #include <variant>
 #include <vector>
 
 namespace dj::detail {
 namespace literal {
-struct Bool {
-	bool value{};
-};
+/// \brief Lexeme (ParseFlag::RawNumbers) converted on first access: other numbers are stored inline in Json.
+/// Conversion is cached, safe for concurrent readers: only the first conversion publishes the payload.
+class Number {
+  public:
+	using Payload = ParsedNumber::Payload;
 
-struct Number {
-	using Payload = std::variant<double, std::uint64_t, std::int64_t>;
+	Number() = default;
+	explicit(false) Number(Payload const& payload) : m_payload(payload) {}
 
-	Payload payload{};
-};
+	/// \brief Create a Number from a (valid) lexeme.
+	[[nodiscard]] static auto from_raw(std::string_view raw) -> Number;
+
+	~Number() = default;
+
+	Number(Number const& other);
+	Number(Number&& other) noexcept;
+	auto operator=(Number const& other) -> Number&;
+	auto operator=(Number&& other) noexcept -> Number&;
+
+	[[nodiscard]] auto get_payload() const -> Payload {
+		if (m_state.load(std::memory_order_acquire) == State::Converted) { return m_payload; }
+		return convert();
+	}
+	/// \brief Obtain the lexeme, empty if not created from one.
+	[[nodiscard]] auto get_raw() const -> std::string_view { return m_raw; }
+
+  private:
+	enum class State : std::uint8_t { Converted, Unconverted, Converting };
+
+	[[nodiscard]] auto convert() const -> Payload;
 
-struct String {
-	std::string text{};
+	template <typename T>
+	void assign(T&& other);
+
+	std::string m_raw{};
+	mutable Payload m_payload{};
+	mutable std::atomic<State> m_state{State::Converted};
 };
 } // namespace literal
 
 struct Array {
-	std::vector<dj::Json> members{};
+	std::pmr::vector<dj::Json> members{};
 };
 
 struct Object {
-	StringTable<dj::Json> members{};
+	using Member = KeyMap<dj::Json>::value_type;
+
+	KeyMap<dj::Json> members{};
 };
 
+/// \brief Value of a Json that cannot be stored inline, shared by copies of it (copy on write).
+/// Only written through a sole reference: Parser::morph() first replaces a shared Value with a copy of it.
 struct Value {
-	using Payload = std::variant<literal::Bool, literal::Number, literal::String, Array, Object>;
+	/// \brief Alternatives in order of JsonType (strings are stored in Json, or shared).
+	using Payload = std::variant<literal::Number, Array, Object>;
 
 	template <typename T>
 	auto morph() -> T& {
@@ -42,5 +76,8 @@ struct Value {
 	}
 
 	Payload payload{};
+	RefCount count{};
+	/// \brief A mutable reference to a member has been handed out (which may be written through at any time): copies copy this Value instead of sharing it.
+	bool pinned{};
 };
 } // namespace dj::detail
@@ -1,6 +1,6 @@
+#include <detail/mapped_file.hpp>
 #include <detail/parser.hpp>
 #include <detail/visitor.hpp>
-#include <charconv>
 #include <filesystem>
 #include <format>
 #include <fstream>
@@ -27,6 +27,12 @@ constexpr auto error_type_str_v = std::array{
 	"Missing end comment ('*/')"sv,
 	"I/O error"sv,
 	"Unsupported feature"sv,
+	"Max depth exceeded"sv,
+	"Invalid UTF-8"sv,
+	"Max size exceeded"sv,
+	"Max string length exceeded"sv,
+	"Max elements exceeded"sv,
+	"Max nodes exceeded"sv,
 };
 
 static_assert(error_type_str_v.size() == std::size_t(Error::Type::COUNT_));
@@ -46,6 +52,53 @@ auto dj::to_string(Error const& error) -> std::string {
 	return ret;
 }
 
+// value
+
+auto dj::detail::literal::Number::from_raw(std::string_view const raw) -> Number {
+	auto ret = Number{};
+	ret.m_raw = raw;
+	ret.m_state.store(State::Unconverted, std::memory_order_relaxed);
+	return ret;
+}
+
+dj::detail::literal::Number::Number(Number const& other) { assign(other); }
+
+dj::detail::literal::Number::Number(Number&& other) noexcept { assign(std::move(other)); }
+
+auto dj::detail::literal::Number::operator=(Number const& other) -> Number& {
+	if (&other != this) { assign(other); }
+	return *this;
+}
+
+auto dj::detail::literal::Number::operator=(Number&& other) noexcept -> Number& {
+	if (&other != this) { assign(std::move(other)); }
+	return *this;
+}
+
+auto dj::detail::literal::Number::convert() const -> Payload {
+	// lexeme was validated by the parser.
+	auto const ret = NumberParser{m_raw}.parse().value_or(Payload{});
+	// only the first reader to finish publishes its result, others return their own (identical) one.
+	auto expected = State::Unconverted;
+	if (m_state.compare_exchange_strong(expected, State::Converting, std::memory_order_acquire)) {
+		m_payload = ret;
+		m_state.store(State::Converted, std::memory_order_release);
+	}
+	return ret;
+}
+
+template <typename T>
+void dj::detail::literal::Number::assign(T&& other) {
+	m_raw = std::forward<T>(other).m_raw;
+	if (other.m_state.load(std::memory_order_acquire) == State::Converted) {
+		m_payload = other.m_payload;
+		m_state.store(State::Converted, std::memory_order_relaxed);
+	} else {
+		m_payload = {};
+		m_state.store(State::Unconverted, std::memory_order_relaxed);
+	}
+}
+
 // parser
 
 namespace dj::detail {
@@ -59,295 +112,480 @@ namespace {
 	}
 }
 
-[[nodiscard]] constexpr auto to_parse_error(ScanError const err) {
-	return Error{
-		.type = to_parse_error_type(err.type),
-		.token = std::string{err.token},
-		.src_loc = err.src_loc,
-	};
+[[nodiscard]] auto make_error(Token const& token, Error::Type const type) -> std::unexpected<ParseError> {
+	return std::unexpected(ParseError{.type = type, .token = token.lexeme, .offset = token.offset});
 }
 
-[[nodiscard]] constexpr auto has_decimal_or_exponent(token::Number const& num) { return num.raw_str.find_first_of(".eE") != std::string_view::npos; }
-
-[[nodiscard]] constexpr auto is_negative(token::Number const& num) { return num.raw_str.starts_with('-'); }
-
-struct Unescape {
-	[[nodiscard]] auto operator()(std::string& out) -> std::optional<Error::Type> {
-		for (char const c : in.escaped) {
-			if (escape) {
-				if (c == 'u') { return Error::Type::UnsupportedFeature; }
-				if (!unescape(out, c)) { return Error::Type::InvalidEscape; }
-				escape = false;
-				continue;
-			}
-			if (c == '\\' && !escape) {
-				escape = true;
-				continue;
-			}
-			out.push_back(c);
-		}
-		if (escape) { return Error::Type::InvalidEscape; }
-		return {};
-	}
+auto const null_json_v = dj::Json{};
+} // namespace
 
-	[[nodiscard]] static auto unescape(std::string& out, char const escaped) -> bool {
-		switch (escaped) {
-		case '\"': out.push_back('\"'); return true;
-		case '\\': out.push_back('\\'); return true;
-		case '/': out.push_back('/'); return true;
-		case 'b': {
-			if (!out.empty()) { out.pop_back(); }
-			return true;
-		}
-		case 'f': {
-			// TODO: WTF is form feed
-			return true;
-		}
-		case 'n': out.push_back('\n'); return true;
-		case 'r': out.push_back('\r'); return true;
-		case 't': out.push_back('\t'); return true;
-		default: return false;
-		}
-	}
+auto to_parse_error(ScanError const& error) -> ParseError {
+	return ParseError{
+		.type = to_parse_error_type(error.type),
+		.token = error.token,
+		.offset = error.offset,
+	};
+}
+
+auto is_jsonc_header(std::string_view const comment) -> bool {
+	static constexpr auto jsonc_headers_v = std::array{
+		"// -*- mode: jsonc -*-"sv,
+		"// -*- jsonc -*-"sv,
+	};
+	return std::ranges::find(jsonc_headers_v, comment) != jsonc_headers_v.end();
+}
 
-	token::String in{};
+StringFactory::StringFactory(ParseOptions const& options, std::string_view const text, std::pmr::memory_resource* arena)
+	: m_key_pool(options.key_pool), m_arena(arena) {
+	if ((options.flags & ParseFlag::BorrowStrings) == ParseFlag::BorrowStrings) { m_source = text; }
+}
 
-	bool escape{};
-};
+auto StringFactory::make_key(std::string_view const key) -> Key {
+	if (is_borrowable(key)) { return Key::borrow(key); }
+	if (m_key_pool != nullptr) { return Key::borrow(intern(key)); }
+	if (m_arena != nullptr) { return Key::borrow(copy_to_arena(key)); }
+	return Key{key};
+}
 
-auto const null_json_v = dj::Json{};
-} // namespace
+void StringFactory::reuse_key(Key& out, std::string_view const key) {
+	if (!out.is_borrowed() && m_key_pool == nullptr && !is_borrowable(key)) { return; }
+	out = make_key(key);
+}
 
-auto Parser::make_json(Value::Payload payload) -> Json {
+auto StringFactory::make_string(std::string_view const value) const -> Json {
 	auto ret = Json{};
-	// NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
-	ret.m_value.reset(new detail::Value{.payload = std::move(payload)});
+	if (is_borrowable(value)) {
+		Parser::set_view(ret, value);
+		return ret;
+	}
+	if (Parser::set_chars(ret, value)) { return ret; }
+	if (m_arena != nullptr) {
+		Parser::set_view(ret, copy_to_arena(value));
+		return ret;
+	}
+	Parser::set_shared(ret, value);
 	return ret;
 }
 
-Parser::Parser(std::string_view const text, ParseMode const mode) : m_mode(mode), m_scanner(text) {}
+void StringFactory::assign_string(Json& out, std::string_view const value) const {
+	if (is_borrowable(value)) {
+		Parser::set_view(out, value);
+		return;
+	}
+	if (Parser::set_chars(out, value)) { return; }
+	if (m_arena != nullptr) {
+		Parser::set_view(out, copy_to_arena(value));
+		return;
+	}
+	Parser::set_shared(out, value);
+}
 
-auto Parser::parse() -> Result {
-	try {
-		check_jsonc_header();
-		if (m_current.is<token::Eof>()) { return null_json_v; }
+auto StringFactory::is_borrowable(std::string_view const text) const -> bool {
+	// unescaped text lives in a buffer owned by the parser.
+	if (m_source.empty()) { return false; }
+	auto const less = std::less<>{};
+	return !less(text.data(), m_source.data()) && !less(m_source.data() + m_source.size(), text.data() + text.size());
+}
 
-		auto ret = parse_value();
-		if (!m_current.is<token::Eof>()) { throw make_error(Error::Type::UnexpectedToken); }
+auto StringFactory::copy_to_arena(std::string_view const text) const -> std::string_view {
+	// borrowed views must not be null, even if empty.
+	if (text.empty()) { return ""; }
+	auto* data = static_cast<char*>(m_arena->allocate(text.size(), alignof(char)));
+	std::ranges::copy(text, data);
+	return std::string_view{data, text.size()};
+}
 
-		return ret;
-	} catch (Error const& err) { return std::unexpected(err); }
-	return null_json_v;
+auto StringFactory::intern(std::string_view const key) -> std::string_view {
+	// keys of successive records repeat: a cheap slot index (and a compare) usually finds them.
+	auto const slot = key.empty() ? 0uz : (key.size() * 31 + std::size_t(key.front()) + std::size_t(key.back())) % m_interned.size();
+	auto& cached = m_interned.at(slot);
+	if (cached.data() == nullptr || cached != key) { cached = m_key_pool->intern(key); }
+	return cached;
 }
 
-auto Parser::next_token() -> Token {
-	auto scan_result = m_scanner.next();
-	if (!scan_result) { throw to_parse_error(scan_result.error()); }
-	return *scan_result;
+JsonBuilder::~JsonBuilder() {
+	if (m_arena == nullptr) { return; }
+	// a partial tree (on error) is released with the arena.
+	for (auto& element : m_elements) { Parser::abandon(element); }
+	for (auto& member : m_members) { Parser::abandon(member.value); }
+	Parser::abandon(m_root);
 }
 
-auto Parser::next_non_comment() -> Token {
-	auto const is_comment = [this](Token const& token) {
-		if (!token.is<token::Comment>()) { return false; }
-		handle_comment(token);
-		return true;
-	};
+void JsonBuilder::on_null() { add(Json{}); }
 
-	auto ret = Token{};
-	do { ret = next_token(); } while (is_comment(ret));
-	return ret;
-}
+void JsonBuilder::on_bool(bool const value) { add(Parser::make_bool(value)); }
 
-void Parser::handle_comment(Token const& token) const {
-	if (m_mode == ParseMode::Strict) { throw make_error(token, Error::Type::UnexpectedComment); }
+JsonBuilder::JsonBuilder(ParseOptions const& options, std::string_view const text, std::pmr::memory_resource* arena)
+	: m_strings(options, text, arena), m_arena(arena), m_raw_numbers((options.flags & ParseFlag::RawNumbers) == ParseFlag::RawNumbers) {}
+
+void JsonBuilder::on_number(ParsedNumber const& value) {
+	if (m_raw_numbers) {
+		add(make_json<literal::Number>(literal::Number::from_raw(value.raw)));
+	} else {
+		add(Parser::make_number(value.payload));
+	}
 }
 
-void Parser::advance() {
-	m_current = m_next;
-	m_next = next_non_comment();
+void JsonBuilder::on_string(std::string_view const value) { add(m_strings.make_string(value)); }
+
+void JsonBuilder::on_key(std::string_view const key) { m_members.push_back(Member{.key = m_strings.make_key(key)}); }
+
+void JsonBuilder::begin_array() { m_stack.push_back(Frame{.first = m_elements.size()}); }
+
+void JsonBuilder::end_array() { close(); }
+
+void JsonBuilder::begin_object() { m_stack.push_back(Frame{.first = m_members.size(), .is_object = true}); }
+
+void JsonBuilder::end_object() { close(); }
+
+void JsonBuilder::close() {
+	assert(!m_stack.empty());
+	auto const frame = m_stack.back();
+	m_stack.pop_back();
+	// allocate each container once, with exactly as many members as it has.
+	if (frame.is_object) {
+		auto const pending = std::span{m_members}.subspan(frame.first);
+		auto object = Object{.members = KeyMap<Json>{get_resource()}};
+		object.members.reserve(pending.size());
+		for (auto& member : pending) {
+			auto const [it, inserted] = object.members.try_emplace(std::move(member.key), std::move(member.value));
+			if (inserted) { continue; }
+			// duplicate key: the later value wins.
+			if (m_arena != nullptr) { Parser::abandon(it->second); }
+			it->second = std::move(member.value);
+		}
+		m_members.resize(frame.first);
+		add(make_json<Object>(std::move(object)));
+	} else {
+		auto const pending = std::span{m_elements}.subspan(frame.first);
+		auto array = Array{.members = std::pmr::vector<Json>{get_resource()}};
+		array.members.assign(std::make_move_iterator(pending.begin()), std::make_move_iterator(pending.end()));
+		m_elements.resize(frame.first);
+		add(make_json<Array>(std::move(array)));
+	}
 }
 
-void Parser::consume(token::Operator const expected, Error::Type const on_error) {
-	if (!m_current.is_operator(expected)) { throw make_error(on_error); }
-	advance();
+void JsonBuilder::add(Json value) {
+	if (m_stack.empty()) {
+		m_root = std::move(value);
+		return;
+	}
+	if (m_stack.back().is_object) {
+		m_members.back().value = std::move(value);
+	} else {
+		m_elements.push_back(std::move(value));
+	}
 }
 
-auto Parser::make_error(Token const token, Error::Type const type) -> Error {
-	return Error{
-		.type = type,
-		.token = std::string{token.lexeme},
-		.src_loc = token.src_loc,
-	};
+EventParser::EventParser(EventHandler& handler, ParseOptions const& options)
+	: m_handler(&handler), m_mode(options.mode), m_max_depth(options.max_depth), m_max_string_length(options.max_string_length),
+	  m_max_elements(options.max_elements), m_max_nodes(options.max_nodes),
+	  m_validate_utf8((options.flags & ParseFlag::ValidateUtf8) == ParseFlag::ValidateUtf8),
+	  m_raw_numbers((options.flags & ParseFlag::RawNumbers) == ParseFlag::RawNumbers) {}
+
+auto EventParser::push(Token const& token) -> Status {
+	if (token.is<token::Comment>()) { return handle_comment(token); }
+	if (m_first) {
+		m_first = false;
+		if (m_mode == ParseMode::Auto) { m_mode = ParseMode::Strict; }
+	}
+
+	switch (m_state) {
+	case State::Document: {
+		if (token.is<token::Eof>()) {
+			m_state = State::Done;
+			return {};
+		}
+		return parse_value(token);
+	}
+	case State::Value: return parse_value(token);
+	case State::FirstElement: {
+		if (token.is_operator(token::Operator::SquareRight)) {
+			close_container();
+			return {};
+		}
+		return parse_value(token);
+	}
+	case State::FirstMember: {
+		if (token.is_operator(token::Operator::BraceRight)) {
+			close_container();
+			return {};
+		}
+		return parse_key(token);
+	}
+	case State::Key: return parse_key(token);
+	case State::Colon: {
+		if (!token.is_operator(token::Operator::Colon)) { return make_error(token, Error::Type::MissingColon); }
+		m_state = State::Value;
+		return {};
+	}
+	case State::AfterValue: return after_value(token);
+	case State::AfterComma: return after_comma(token);
+	case State::End: {
+		if (!token.is<token::Eof>()) { return make_error(token, Error::Type::UnexpectedToken); }
+		m_state = State::Done;
+		return {};
+	}
+	case State::Done:
+	default: assert(false && "token pushed after Eof"); return {};
+	}
 }
 
-auto Parser::make_error(Error::Type const type) const -> Error { return make_error(m_current, type); }
+auto EventParser::handle_comment(Token const& token) -> Status {
+	if (m_mode == ParseMode::Strict) { return make_error(token, Error::Type::UnexpectedComment); }
+	if (m_first) {
+		m_first = false;
+		if (m_mode == ParseMode::Auto) { m_mode = is_jsonc_header(token.lexeme) ? ParseMode::Jsonc : ParseMode::Strict; }
+	}
+	return {};
+}
+
+auto EventParser::parse_value(Token const& token) -> Status {
+	if (token.is<token::Eof>()) { return make_error(token, Error::Type::UnexpectedEof); }
+	// budgets are checked before the value is built.
+	if (++m_nodes > m_max_nodes) { return make_error(token, Error::Type::MaxNodesExceeded); }
+	if (!m_containers.empty() && ++m_containers.back().count > m_max_elements) { return make_error(token, Error::Type::MaxElementsExceeded); }
+	if (auto const* op = std::get_if<token::Operator>(&token.type)) { return from_operator(token, *op); }
+	if (auto const* num = std::get_if<token::Number>(&token.type)) { return make_number(token, *num); }
+	assert(token.is<token::String>());
+	return make_string(token, std::get<token::String>(token.type));
+}
+
+auto EventParser::parse_key(Token const& token) -> Status {
+	auto const* string = std::get_if<token::String>(&token.type);
+	if (!string) { return make_error(token, Error::Type::MissingKey); }
+	auto const key = unescape_string(token, *string);
+	if (!key) { return std::unexpected(key.error()); }
+	m_handler->on_key(*key);
+	m_state = State::Colon;
+	return {};
+}
+
+auto EventParser::after_value(Token const& token) -> Status {
+	assert(!m_containers.empty());
+	if (token.is_operator(token::Operator::Comma)) {
+		m_state = State::AfterComma;
+		return {};
+	}
+	auto const closing = m_containers.back().closer;
+	if (!token.is_operator(closing)) {
+		return make_error(token, closing == token::Operator::BraceRight ? Error::Type::MissingBrace : Error::Type::MissingBracket);
+	}
+	close_container();
+	return {};
+}
 
-auto Parser::parse_value() -> Json {
-	if (m_current.is<token::Eof>()) { throw make_error(Error::Type::UnexpectedEof); }
-	if (auto const* op = std::get_if<token::Operator>(&m_current.type)) { return from_operator(*op); }
-	if (auto const* num = std::get_if<token::Number>(&m_current.type)) {
-		if (has_decimal_or_exponent(*num)) { return make_number<double>(*num); }
-		if (is_negative(*num)) { return make_number<std::int64_t>(*num); }
-		return make_number<std::uint64_t>(*num);
+auto EventParser::after_comma(Token const& token) -> Status {
+	assert(!m_containers.empty());
+	auto const closing = m_containers.back().closer;
+	// trailing comma
+	if (m_mode != ParseMode::Strict && token.is_operator(closing)) {
+		close_container();
+		return {};
 	}
-	assert(m_current.is<token::String>());
-	return make_string(std::get<token::String>(m_current.type));
+	if (closing == token::Operator::BraceRight) { return parse_key(token); }
+	return parse_value(token);
 }
 
-auto Parser::from_operator(token::Operator const op) -> Json {
-	auto ret = Json{};
+auto EventParser::from_operator(Token const& token, token::Operator const op) -> Status {
 	switch (op) {
-	case token::Operator::Null: ret = null_json_v; break;
-	case token::Operator::True: ret = make_json(literal::Bool{.value = true}); break;
-	case token::Operator::False: ret = make_json(literal::Bool{.value = false}); break;
-	case token::Operator::SquareLeft: return make_array();
-	case token::Operator::BraceLeft: return make_object();
+	case token::Operator::Null: m_handler->on_null(); break;
+	case token::Operator::True: m_handler->on_bool(true); break;
+	case token::Operator::False: m_handler->on_bool(false); break;
+
+	case token::Operator::BraceLeft:
+	case token::Operator::SquareLeft: return open_container(token);
 
 	case token::Operator::Comma:
 	case token::Operator::Colon:
 	case token::Operator::SquareRight:
 	case token::Operator::BraceRight:
-	default: throw make_error(Error::Type::UnexpectedToken);
+	default: return make_error(token, Error::Type::UnexpectedToken);
 	}
 
-	advance();
-	return ret;
+	complete_value();
+	return {};
 }
 
-template <typename T>
-auto Parser::make_number(token::Number const in) -> Json {
-	auto value = T{};
-	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-	auto const* end = in.raw_str.data() + in.raw_str.size();
-	auto const [ptr, ec] = std::from_chars(in.raw_str.data(), end, value);
-	if (ec != std::errc{} || ptr != end) { throw make_error(Error::Type::InvalidNumber); }
-	advance();
-	return make_json(literal::Number{.payload = value});
-}
-
-auto Parser::make_string(token::String const in) -> Json {
-	auto ret = detail::literal::String{};
-	ret.text = unescape_string(in);
-	advance();
-	return make_json(std::move(ret));
-}
-
-auto Parser::iterate_unless(token::Operator const op) -> bool {
-	if (!m_current.is_operator(token::Operator::Comma)) { return false; }
-	advance();
-	if (m_mode == ParseMode::Strict) {
-		// require more content after ','
-		return true;
-	}
-	if (m_current.is_operator(op)) { return false; }
-	return true;
+auto EventParser::make_number(Token const& token, token::Number const in) -> Status {
+	if (m_raw_numbers) {
+		// conversion is deferred to the handler.
+		if (!NumberParser{in.raw_str}.validate()) { return make_error(token, Error::Type::InvalidNumber); }
+		m_handler->on_number(ParsedNumber{.raw = in.raw_str});
+		complete_value();
+		return {};
+	}
+	auto const payload = to_number(in);
+	if (!payload) { return make_error(token, Error::Type::InvalidNumber); }
+	m_handler->on_number(ParsedNumber{.raw = in.raw_str, .payload = *payload});
+	complete_value();
+	return {};
+}
+
+auto EventParser::make_string(Token const& token, token::String const in) -> Status {
+	auto const text = unescape_string(token, in);
+	if (!text) { return std::unexpected(text.error()); }
+	m_handler->on_string(*text);
+	complete_value();
+	return {};
+}
+
+auto EventParser::open_container(Token const& token) -> Status {
+	if (m_containers.size() >= m_max_depth) { return make_error(token, Error::Type::MaxDepthExceeded); }
+	if (token.is_operator(token::Operator::BraceLeft)) {
+		m_containers.push_back(Container{.closer = token::Operator::BraceRight});
+		m_handler->begin_object();
+		m_state = State::FirstMember;
+	} else {
+		m_containers.push_back(Container{.closer = token::Operator::SquareRight});
+		m_handler->begin_array();
+		m_state = State::FirstElement;
+	}
+	return {};
 }
 
-auto Parser::make_array() -> Json {
-	assert(m_current.is_operator(token::Operator::SquareLeft));
-	auto ret = Array{};
-	advance();
-	if (!m_current.is_operator(token::Operator::SquareRight)) {
-		do { ret.members.push_back(parse_value()); } while (iterate_unless(token::Operator::SquareRight));
+void EventParser::close_container() {
+	assert(!m_containers.empty());
+	if (m_containers.back().closer == token::Operator::BraceRight) {
+		m_handler->end_object();
+	} else {
+		m_handler->end_array();
 	}
-	consume(token::Operator::SquareRight, Error::Type::MissingBracket);
-	return make_json(std::move(ret));
+	m_containers.pop_back();
+	complete_value();
 }
 
-auto Parser::make_object() -> Json {
-	assert(m_current.is_operator(token::Operator::BraceLeft));
-	auto ret = Object{};
-	advance();
-	if (!m_current.is_operator(token::Operator::BraceRight)) {
-		do {
-			auto key = make_key();
-			consume(token::Operator::Colon, Error::Type::MissingColon);
-			auto value = parse_value();
-			ret.members.insert_or_assign(std::move(key), std::move(value));
-		} while (iterate_unless(token::Operator::BraceRight));
+void EventParser::complete_value() { m_state = m_containers.empty() ? State::End : State::AfterValue; }
+
+auto EventParser::unescape_string(Token const& token, token::String const in) -> Expected<std::string_view> {
+	if (in.escaped.size() > m_max_string_length) { return make_error(token, Error::Type::MaxStringLengthExceeded); }
+	if (simd::find_backslash(in.escaped) == in.escaped.size()) {
+		if (m_validate_utf8 && !utf8::is_valid(in.escaped)) { return make_error(token, Error::Type::InvalidUtf8); }
+		return in.escaped;
 	}
-	consume(token::Operator::BraceRight, Error::Type::MissingBrace);
-	return make_json(std::move(ret));
+	m_buffer.clear();
+	auto const error = Unescape{.in = in}(m_buffer);
+	if (error) { return make_error(token, *error); }
+	// the unescaped text is validated: that is what is stored.
+	if (m_validate_utf8 && !utf8::is_valid(m_buffer)) { return make_error(token, Error::Type::InvalidUtf8); }
+	return m_buffer;
 }
 
-auto Parser::unescape_string(token::String const in) const -> std::string {
-	auto ret = std::string{};
-	ret.reserve(in.escaped.size());
-	auto const error = Unescape{.in = in}(ret);
-	if (error) { throw make_error(*error); }
+auto Parser::make_json(Value::Payload payload) -> Json {
+	auto ret = Json{};
+	// NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+	ret.store(Json::Kind::Value, new detail::Value{.payload = std::move(payload)});
 	return ret;
 }
 
-auto Parser::make_key() -> std::string {
-	auto const* string = std::get_if<token::String>(&m_current.type);
-	if (!string) { throw make_error(Error::Type::MissingKey); }
-	auto ret = unescape_string(*string);
-	advance();
-	return ret;
+void Parser::abandon(Json& json) { json.m_kind = Json::Kind::Null; }
+
+auto Parser::unshare(Json& json) -> Value* {
+	auto* ret = json.get_value();
+	if (ret == nullptr || ret->count.is_unique()) { return ret; }
+	// copies the members of a container: each of them retains its own Value / string.
+	// NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+	json.store(Json::Kind::Value, new Value{.payload = ret->payload});
+	return json.get_value();
 }
 
-void Parser::check_jsonc_header() {
-	auto const token = next_token();
-	if (!token.is<token::Comment>()) {
-		if (m_mode == ParseMode::Auto) { m_mode = ParseMode::Strict; }
-		m_current = token;
-		m_next = next_non_comment();
-		return;
-	}
+Parser::Parser(std::string_view const text, ParseOptions const& options) : m_options(options), m_text(text), m_scanner(text) {}
 
-	handle_comment(token);
+Parser::Parser(std::string_view const text, ParseMode const mode) : Parser(text, ParseOptions{.mode = mode}) {}
 
-	if (m_mode == ParseMode::Auto) {
-		static constexpr auto jsonc_headers_v = std::array{
-			"// -*- mode: jsonc -*-"sv,
-			"// -*- jsonc -*-"sv,
-		};
-		if (std::ranges::find(jsonc_headers_v, token.lexeme) != jsonc_headers_v.end()) {
-			m_mode = ParseMode::Jsonc;
-		} else {
-			m_mode = ParseMode::Strict;
+auto Parser::parse() -> Result {
+	auto builder = JsonBuilder{m_options, m_text};
+	if (auto result = parse(builder); !result) { return std::unexpected(std::move(result.error())); }
+	return builder.release();
+}
+
+auto Parser::parse(EventHandler& handler) -> std::expected<void, Error> {
+	// located at the first byte beyond the budget.
+	if (m_text.size() > m_options.max_size) { return std::unexpected(to_error(ParseError{.type = Error::Type::MaxSizeExceeded, .offset = m_options.max_size})); }
+	auto parser = EventParser{handler, m_options};
+	auto deferred = std::optional<ParseError>{};
+	while (true) {
+		auto const token = m_scanner.next();
+		if (!token) { return std::unexpected(to_error(to_parse_error(token.error()))); }
+		if (deferred && !token->is<token::Comment>()) { return std::unexpected(to_error(*deferred)); }
+
+		auto const result = parser.push(*token);
+		if (!result) {
+			if (token->is<token::Comment>() || token->is<token::Eof>()) { return std::unexpected(to_error(result.error())); }
+			deferred = result.error();
+			continue;
 		}
+		if (token->is<token::Eof>()) { return {}; }
 	}
-	m_current = next_non_comment();
-	m_next = next_non_comment();
+}
+
+auto Parser::to_error(ParseError const& error) const -> Error {
+	return Error{
+		.type = error.type,
+		.token = std::string{error.token},
+		.src_loc = m_scanner.get_src_loc(error.offset),
+		.offset = error.offset,
+	};
 }
 } // namespace dj::detail
 
+auto dj::parse_events(std::string_view const text, EventHandler& handler, ParseOptions const& options) -> std::expected<void, Error> {
+	return detail::Parser{text, options}.parse(handler);
+}
+
 // json
 
 namespace dj {
 namespace fs = std::filesystem;
 
 namespace {
-template <JsonType T>
-using value_payload_type = std::variant_alternative_t<std::size_t(T) - 1, detail::Value::Payload>;
+/// \brief JsonType of each alternative of detail::Value::Payload.
+constexpr auto payload_type_v = std::array{JsonType::Number, JsonType::Array, JsonType::Object};
 
-static_assert(std::same_as<value_payload_type<JsonType::Boolean>, detail::literal::Bool>);
-static_assert(std::same_as<value_payload_type<JsonType::Number>, detail::literal::Number>);
-static_assert(std::same_as<value_payload_type<JsonType::String>, detail::literal::String>);
-static_assert(std::same_as<value_payload_type<JsonType::Array>, detail::Array>);
-static_assert(std::same_as<value_payload_type<JsonType::Object>, detail::Object>);
+static_assert(payload_type_v.size() == std::variant_size_v<detail::Value::Payload>);
+static_assert(std::same_as<std::variant_alternative_t<0, detail::Value::Payload>, detail::literal::Number>);
+static_assert(std::same_as<std::variant_alternative_t<1, detail::Value::Payload>, detail::Array>);
+static_assert(std::same_as<std::variant_alternative_t<2, detail::Value::Payload>, detail::Object>);
 
 template <typename T>
-[[nodiscard]] constexpr auto to_number(detail::literal::Number const in) {
+[[nodiscard]] auto to_number(detail::literal::Number const& in) {
 	auto const visitor = [](auto const n) { return static_cast<T>(n); };
-	return std::visit(visitor, in.payload);
+	return std::visit(visitor, in.get_payload());
 }
 
-[[nodiscard]] auto file_to_string(std::string_view const path, std::string& out) {
+/// \brief Minimum buffer size for reading files.
+constexpr auto read_chunk_v = 4096uz;
+
+[[nodiscard]] auto is_file_path(std::string_view const path) -> bool {
 	if (path.empty()) { return false; }
+	auto const fs_path = fs::path{path};
+	auto err = std::error_code{};
+	return !fs::is_directory(fs_path, err) && !fs::is_symlink(fs_path, err);
+}
+
+/// \param limit Maximum number of bytes to read.
+[[nodiscard]] auto file_to_string(std::string_view const path, std::string& out, std::size_t const limit) {
+	if (!is_file_path(path)) { return false; }
 
 	auto const fs_path = fs::path{path};
 	auto err = std::error_code{};
-	if (fs::is_directory(fs_path, err) || fs::is_symlink(fs_path, err)) { return false; }
 
-	auto file = std::ifstream{fs_path, std::ios::binary | std::ios::ate};
+	auto file = std::ifstream{fs_path, std::ios::binary};
 	if (!file.is_open()) { return false; }
 
-	auto const size = file.tellg();
-	file.seekg(0, std::ios::beg);
-	out.resize(std::size_t(size));
-	return !!file.read(out.data(), size);
+	// the size of pipes and special files is not known upfront: read until EOF.
+	// one extra byte lets regular files hit EOF on the first read.
+	auto const size = fs::file_size(fs_path, err);
+	out.resize(std::min(err ? read_chunk_v : std::max(std::size_t(size) + 1, read_chunk_v), limit));
+	auto length = 0uz;
+	while (file.read(out.data() + length, std::streamsize(out.size() - length))) {
+		length = out.size();
+		if (length >= limit) { return true; }
+		out.resize(std::min(2 * length, limit));
+	}
+	if (file.bad()) { return false; }
+	out.resize(length + std::size_t(file.gcount()));
+	return true;
 }
 
 [[nodiscard]] auto string_to_file(std::string_view const path, std::string_view const text) {
@@ -363,8 +601,6 @@ template <typename T>
 	auto file = std::ofstream{fs_path};
 	return !!(file << text);
 }
-
-auto const empty_object_v = detail::Object{};
 } // namespace
 
 struct Json::Serializer {
@@ -382,23 +618,39 @@ struct Json::Serializer {
 
   private:
 	using Flag = SerializeFlag;
+	using Kind = Json::Kind;
 
 	[[nodiscard]] constexpr auto is_set(SerializeFlags const flag) const -> bool { return (m_options.flags & flag) == flag; }
 
 	void process(dj::Json const& json) {
-		if (json.is_null()) {
-			append("null,");
-			return;
+		switch (json.m_kind) {
+		case Kind::Null: append("null,"); return;
+		case Kind::Bool: append("{},", json.load<bool>()); return;
+		case Kind::I64: append("{},", json.load<std::int64_t>()); return;
+		case Kind::U64: append("{},", json.load<std::uint64_t>()); return;
+		case Kind::F64: append("{},", json.load<double>()); return;
+		case Kind::Chars: append(R"("{}",)", json.get_chars()); return;
+		case Kind::View: append(R"("{}",)", json.get_view()); return;
+		case Kind::Shared: append(R"("{}",)", detail::Parser::get_shared(json)->get_text()); return;
+		case Kind::Value: break;
 		}
 
 		auto const visitor = detail::Visitor{
-			[this](detail::literal::Bool const b) { append("{},", b.value); },
-			[this](detail::literal::Number const n) { std::visit([this](auto const n) { append("{},", n); }, n.payload); },
-			[this](detail::literal::String const& s) { append(R"("{}",)", s.text); },
+			[this](detail::literal::Number const& n) { process_number(n); },
 			[this](detail::Array const& a) { process_array(a); },
 			[this](detail::Object const& o) { process_object(o); },
 		};
-		std::visit(visitor, json.m_value->payload);
+		std::visit(visitor, json.get_value()->payload);
+	}
+
+	void process_number(detail::literal::Number const& number) {
+		// lexemes are emitted verbatim, without converting them.
+		if (auto const raw = number.get_raw(); !raw.empty()) [[unlikely]] {
+			m_ret.append(raw);
+			m_ret.push_back(',');
+			return;
+		}
+		std::visit([this](auto const n) { append("{},", n); }, number.get_payload());
 	}
 
 	void process_array(detail::Array const& array) {
@@ -426,23 +678,16 @@ struct Json::Serializer {
 			return;
 		}
 
-		auto const sort_keys = is_set(Flag::SortKeys) && object.members.size() > 1;
-		auto sorted_keys = std::vector<std::string_view>{};
-		if (sort_keys) {
-			sorted_keys.reserve(object.members.size());
-			for (auto const& [key, _] : object.members) { sorted_keys.push_back(key); }
-			std::ranges::sort(sorted_keys);
-		}
-
 		m_ret.push_back('{');
 		++m_indents;
 
-		if (sort_keys) {
-			for (auto const key : sorted_keys) {
-				auto const it = object.members.find(key);
-				assert(it != object.members.end());
-				subprocess_object(key, it->second);
-			}
+		// members are in insertion order: sorting their addresses avoids looking each up again.
+		if (is_set(Flag::SortKeys) && object.members.size() > 1) {
+			auto sorted = std::vector<detail::Object::Member const*>{};
+			sorted.reserve(object.members.size());
+			for (auto const& member : object.members) { sorted.push_back(&member); }
+			std::ranges::sort(sorted, {}, [](detail::Object::Member const* member) { return member->first.view(); });
+			for (auto const* member : sorted) { subprocess_object(member->first, member->second); }
 		} else {
 			for (auto const& [key, value] : object.members) { subprocess_object(key, value); }
 		}
@@ -488,31 +733,94 @@ struct Json::Serializer {
 	std::uint8_t m_indents{};
 };
 
-void Json::Deleter::operator()(detail::Value* ptr) const noexcept { std::default_delete<detail::Value>{}(ptr); }
-
 Json::Json(Json const& other) {
-	// NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
-	if (other.m_value) { m_value.reset(new detail::Value{*other.m_value}); }
+	if (auto const* value = other.get_value(); value != nullptr && value->pinned) {
+		// members may be written through references handed out earlier: copy them now (pinned ones in turn).
+		// NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+		store(Kind::Value, new detail::Value{.payload = value->payload});
+		return;
+	}
+	m_data = other.m_data;
+	m_size = other.m_size;
+	m_kind = other.m_kind;
+	retain();
 }
 
 auto Json::operator=(Json const& other) -> Json& {
-	if (&other != this) {
-		if (!other.m_value) {
-			m_value.reset();
-		} else {
-			ensure_impl();
-			*m_value = *other.m_value;
-		}
-	}
+	if (&other == this) { return *this; }
+	// retain before releasing own: both may share the same string / Value.
+	auto copy = Json{other};
+	swap(*this, copy);
 	return *this;
 }
 
-auto Json::parse(std::string_view const text, ParseMode const mode) -> Result { return detail::Parser{text, mode}.parse(); }
+void Json::retain() const {
+	if (auto* shared = detail::Parser::get_shared(*this)) {
+		detail::SharedString::retain(shared);
+	} else if (auto* value = get_value()) {
+		value->count.retain();
+	}
+}
+
+void Json::release() noexcept {
+	if (m_kind == Kind::Shared) {
+		detail::SharedString::release(load<detail::SharedString*>());
+		return;
+	}
+	auto* value = load<detail::Value*>();
+	if (value->count.release()) { delete value; } // NOLINT(cppcoreguidelines-owning-memory)
+}
+
+template <NumericT T>
+auto Json::get_number(T const fallback) const -> T {
+	switch (m_kind) {
+	case Kind::I64: return static_cast<T>(load<std::int64_t>());
+	case Kind::U64: return static_cast<T>(load<std::uint64_t>());
+	case Kind::F64: return static_cast<T>(load<double>());
+	case Kind::Value: {
+		auto const* number = std::get_if<detail::literal::Number>(&get_value()->payload);
+		return number != nullptr ? to_number<T>(*number) : fallback;
+	}
+	default: return fallback;
+	}
+}
+
+auto Json::parse(std::string_view const text, ParseMode const mode) -> Result { return parse(text, ParseOptions{.mode = mode}); }
+
+auto Json::parse(std::string_view const text, ParseOptions const& options) -> Result {
+	if (options.threads != 1) {
+		if (auto ret = detail::Parser::parse_parallel(text, options)) { return std::move(*ret); }
+	}
+	return detail::Parser{text, options}.parse();
+}
+
+auto Json::parse_into(Json& target, std::string_view const text, ParseMode const mode) -> std::expected<void, Error> {
+	return parse_into(target, text, ParseOptions{.mode = mode});
+}
+
+auto Json::parse_into(Json& target, std::string_view const text, ParseOptions const& options) -> std::expected<void, Error> {
+	return detail::Parser{text, options}.parse_into(target);
+}
+
+auto Json::from_file(std::string_view const path, ParseMode const mode) -> Result { return from_file(path, ParseOptions{.mode = mode}); }
+
+auto Json::from_file(std::string_view const path, ParseOptions const& in_options) -> Result {
+	// file contents do not outlive this call.
+	auto options = in_options;
+	options.flags &= ParseFlags(~ParseFlag::BorrowStrings);
+	auto const is_set = [&options](FileFlags const flag) { return (options.file_flags & flag) == flag; };
+	if (is_set(FileFlag::MemoryMap) && is_file_path(path)) {
+		// parse directly from the mapping, falls back to reading into a buffer if the file cannot be mapped.
+		auto const file = detail::MappedFile::map(path, is_set(FileFlag::HugePages));
+		if (file) { return parse(file->get_text(), options); }
+	}
 
-auto Json::from_file(std::string_view const path, ParseMode const mode) -> Result {
 	auto text = std::string{};
-	if (!file_to_string(path, text)) { return std::unexpected(Error{.type = Error::Type::IoError}); }
-	return parse(text, mode);
+	// read one byte past max_size (if set) for the parser to report exceeding it, without reading the whole file.
+	auto const max_length = text.max_size();
+	auto const limit = options.max_size < max_length ? std::size_t(options.max_size) + 1 : max_length;
+	if (!file_to_string(path, text, limit)) { return std::unexpected(Error{.type = Error::Type::IoError}); }
+	return parse(text, options);
 }
 
 auto Json::empty_array() -> Json const& {
@@ -526,92 +834,86 @@ auto Json::empty_object() -> Json const& {
 }
 
 auto Json::get_type() const -> Type {
-	if (m_value) { return Type(m_value->payload.index() + 1); }
+	switch (m_kind) {
+	case Kind::Null: return Type::Null;
+	case Kind::Bool: return Type::Boolean;
+	case Kind::I64:
+	case Kind::U64:
+	case Kind::F64: return Type::Number;
+	case Kind::Chars:
+	case Kind::View:
+	case Kind::Shared: return Type::String;
+	case Kind::Value: return payload_type_v.at(get_value()->payload.index());
+	}
 	return Type::Null;
 }
 
 auto Json::as_bool(bool const fallback) const -> bool {
-	if (!is_boolean()) { return fallback; }
-	return std::get<detail::literal::Bool>(m_value->payload).value;
+	if (m_kind != Kind::Bool) { return fallback; }
+	return load<bool>();
 }
 
-auto Json::as_double(double const fallback) const -> double {
-	if (!is_number()) { return fallback; }
-	return to_number<double>(std::get<detail::literal::Number>(m_value->payload));
-}
+auto Json::as_double(double const fallback) const -> double { return get_number(fallback); }
 
-auto Json::as_u64(std::uint64_t const fallback) const -> std::uint64_t {
-	if (!is_number()) { return fallback; }
-	return to_number<std::uint64_t>(std::get<detail::literal::Number>(m_value->payload));
-}
+auto Json::as_u64(std::uint64_t const fallback) const -> std::uint64_t { return get_number(fallback); }
 
-auto Json::as_i64(std::int64_t const fallback) const -> std::int64_t {
-	if (!is_number()) { return fallback; }
-	return to_number<std::int64_t>(std::get<detail::literal::Number>(m_value->payload));
-}
+auto Json::as_i64(std::int64_t const fallback) const -> std::int64_t { return get_number(fallback); }
 
 auto Json::as_string_view(std::string_view const fallback) const -> std::string_view {
-	if (!is_string()) { return fallback; }
-	return std::get<detail::literal::String>(m_value->payload).text;
+	switch (m_kind) {
+	case Kind::Chars: return get_chars();
+	case Kind::View: return get_view();
+	case Kind::Shared: return detail::Parser::get_shared(*this)->get_text();
+	default: return fallback;
+	}
 }
 
 auto Json::as_array() const -> std::span<Json const> {
 	if (!is_array()) { return {}; }
-	return std::get<detail::Array>(m_value->payload).members;
+	return std::get<detail::Array>(get_value()->payload).members;
 }
 
-auto Json::as_object() const -> StringTable<Json> const& {
-	if (!is_object()) { return empty_object_v.members; }
-	return std::get<detail::Object>(m_value->payload).members;
+auto Json::as_object() const -> KeyMapView<Json> {
+	if (!is_object()) { return {}; }
+	return std::get<detail::Object>(get_value()->payload).members;
 }
 
-void Json::set_null() { m_value.reset(); }
+void Json::set_null() { reset(); }
 
-void Json::set_boolean(bool const value) {
-	ensure_impl();
-	m_value->payload = detail::literal::Bool{.value = value};
-}
+void Json::set_boolean(bool const value) { store(Kind::Bool, value); }
 
 void Json::set_string(std::string_view const value) {
-	ensure_impl();
-	m_value->payload = detail::literal::String{.text = make_escaped(value)};
+	auto escaped = make_escaped(value);
+	if (escaped.size() <= chars_capacity_v) {
+		set_chars(escaped);
+		return;
+	}
+	detail::Parser::set_shared(*this, escaped);
 }
 
-void Json::set_number(std::int64_t const value) {
-	ensure_impl();
-	m_value->payload = detail::literal::Number{.payload = value};
-}
+void Json::set_number(std::int64_t const value) { store(Kind::I64, value); }
 
-void Json::set_number(std::uint64_t const value) {
-	ensure_impl();
-	m_value->payload = detail::literal::Number{.payload = value};
-}
+void Json::set_number(std::uint64_t const value) { store(Kind::U64, value); }
 
-void Json::set_number(double const value) {
-	ensure_impl();
-	m_value->payload = detail::literal::Number{.payload = value};
-}
+void Json::set_number(double const value) { store(Kind::F64, value); }
 
-void Json::set_value(Json value) { m_value = std::move(value.m_value); }
+void Json::set_value(Json value) { *this = std::move(value); }
 
 void Json::set_array() {
-	ensure_impl();
-	m_value->morph<detail::Array>().members.clear();
+	// a shared Value would be copied only to be cleared.
+	if (auto const* value = get_value(); value != nullptr && !value->count.is_unique()) { reset(); }
+	detail::Parser::morph<detail::Array>(*this).members.clear();
 }
 
 void Json::set_object() {
-	ensure_impl();
-	m_value->morph<detail::Object>().members.clear();
+	if (auto const* value = get_value(); value != nullptr && !value->count.is_unique()) { reset(); }
+	detail::Parser::morph<detail::Object>(*this).members.clear();
 }
 
-auto Json::push_back(Json value) -> Json& {
-	ensure_impl();
-	return m_value->morph<detail::Array>().members.emplace_back(std::move(value));
-}
+auto Json::push_back(Json value) -> Json& { return detail::Parser::pin<detail::Array>(*this).members.emplace_back(std::move(value)); }
 
 auto Json::insert_or_assign(std::string key, Json value) -> Json& {
-	ensure_impl();
-	auto& table = m_value->morph<detail::Object>().members;
+	auto& table = detail::Parser::pin<detail::Object>(*this).members;
 	auto const [it, _] = table.insert_or_assign(std::move(key), std::move(value));
 	assert(it != table.end());
 	return it->second;
@@ -619,31 +921,28 @@ auto Json::insert_or_assign(std::string key, Json value) -> Json& {
 
 auto Json::operator[](std::string_view const key) const -> Json const& {
 	if (!is_object()) { return detail::null_json_v; }
-	auto const& object = std::get<detail::Object>(m_value->payload);
+	auto const& object = std::get<detail::Object>(get_value()->payload);
 	auto const it = object.members.find(key);
 	if (it == object.members.end()) { return detail::null_json_v; }
 	return it->second;
 }
 
 auto Json::operator[](std::string_view const key) -> Json& {
-	ensure_impl();
-	auto& object = m_value->morph<detail::Object>();
+	auto& object = detail::Parser::pin<detail::Object>(*this);
 	auto it = object.members.find(key);
-	if (it == object.members.end()) { it = object.members.insert_or_assign(std::string{key}, Json{}).first; }
-	assert(it != object.members.end());
+	if (it == object.members.end()) { it = object.members.try_emplace(std::string{key}).first; }
 	return it->second;
 }
 
 auto Json::operator[](std::size_t const index) const -> Json const& {
 	if (!is_array()) { return detail::null_json_v; }
-	auto const& array = std::get<detail::Array>(m_value->payload);
+	auto const& array = std::get<detail::Array>(get_value()->payload);
 	if (index >= array.members.size()) { return detail::null_json_v; }
 	return array.members.at(index);
 }
 
 auto Json::operator[](std::size_t const index) -> Json& {
-	ensure_impl();
-	auto& array = m_value->morph<detail::Array>();
+	auto& array = detail::Parser::pin<detail::Array>(*this);
 	if (index >= array.members.size()) { array.members.resize(index + 1); }
 	return array.members.at(index);
 }
@@ -655,12 +954,6 @@ auto Json::to_file(std::string_view const path, SerializeOptions const& options)
 	auto const text = serialize(options);
 	return string_to_file(path, text);
 }
-
-void Json::ensure_impl() {
-	if (m_value) { return; }
-	// NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
-	m_value.reset(new detail::Value);
-}
 } // namespace dj
 
 auto dj::make_escaped(std::string_view const text) -> std::string {
@@ -670,6 +963,8 @@ auto dj::make_escaped(std::string_view const text) -> std::string {
 		switch (c) {
 		case '\"':
 		case '\\': ret.push_back('\\'); break;
+		case '\b': ret.append("\\b"); continue;
+		case '\f': ret.append("\\f"); continue;
 		case '\t': ret.append("\\t"); continue;
 		case '\n': ret.append("\\n"); continue;
 		case '\r': ret.append("\\r"); continue;
@@ -0,0 +1,88 @@
+#include <detail/parser.hpp>
+#include <djson/document.hpp>
+#include <algorithm>
+#include <memory_resource>
+
+namespace dj {
+namespace {
+/// \brief Forwards to the heap, tracking the total size allocated.
+class CountingResource final : public std::pmr::memory_resource {
+  public:
+	[[nodiscard]] auto get_size() const -> std::size_t { return m_size; }
+
+  private:
+	auto do_allocate(std::size_t const bytes, std::size_t const alignment) -> void* final {
+		auto* ret = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		m_size += bytes;
+		return ret;
+	}
+
+	void do_deallocate(void* ptr, std::size_t const bytes, std::size_t const alignment) final {
+		std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+	}
+
+	[[nodiscard]] auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool final { return &other == this; }
+
+	std::size_t m_size{};
+};
+
+/// \brief Initial size of the arena per byte of input text: enough for the text itself and a typical tree.
+constexpr std::size_t arena_bytes_per_byte_v{4};
+} // namespace
+
+struct Document::Impl {
+	explicit Impl(std::size_t const text_size) : arena(std::max(text_size * arena_bytes_per_byte_v, 1024uz), &upstream) {}
+
+	Impl(Impl const&) = delete;
+	Impl(Impl&&) = delete;
+	auto operator=(Impl const&) -> Impl& = delete;
+	auto operator=(Impl&&) -> Impl& = delete;
+
+	// the tree is never destroyed: all its memory is released along with the arena.
+	~Impl() = default;
+
+	CountingResource upstream{};
+	std::pmr::monotonic_buffer_resource arena;
+	Json const* root{};
+};
+
+Document::Document() = default;
+Document::~Document() = default;
+Document::Document(Document&&) noexcept = default;
+auto Document::operator=(Document&&) noexcept -> Document& = default;
+
+auto Document::parse(std::string_view const text, ParseMode const mode) -> std::expected<Document, Error> { return parse(text, ParseOptions{.mode = mode}); }
+
+auto Document::parse(std::string_view const text, ParseOptions const& options) -> std::expected<Document, Error> {
+	// fail before allocating the arena.
+	if (text.size() > options.max_size) { return std::unexpected(Json::parse(text, options).error()); }
+
+	auto ret = Document{};
+	ret.m_impl = std::make_unique<Impl>(text.size());
+	auto& arena = ret.m_impl->arena;
+
+	// copy the text into the arena, and borrow all strings and keys without escapes from it.
+	auto* source_data = static_cast<char*>(arena.allocate(text.size(), alignof(char)));
+	std::ranges::copy(text, source_data);
+	auto const source = std::string_view{source_data, text.size()};
+	auto arena_options = options;
+	arena_options.flags = ParseFlags((arena_options.flags | ParseFlag::BorrowStrings) & ~ParseFlag::RawNumbers);
+
+	// the builder never destroys Values (even on failure): they are released with the arena.
+	auto builder = detail::JsonBuilder{arena_options, source, &arena};
+	if (auto result = detail::Parser{source, arena_options}.parse(builder); !result) { return std::unexpected(std::move(result.error())); }
+	ret.m_impl->root = std::pmr::polymorphic_allocator<Json>{&arena}.new_object<Json>(builder.release());
+	return ret;
+}
+
+auto Document::root() const -> Json const& {
+	static auto const null_json = Json{};
+	if (!m_impl || m_impl->root == nullptr) { return null_json; }
+	return *m_impl->root;
+}
+
+auto Document::arena_size() const -> std::size_t {
+	if (!m_impl) { return 0; }
+	return m_impl->upstream.get_size();
+}
+} // namespace dj
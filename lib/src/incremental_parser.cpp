@@ -0,0 +1,294 @@
+#include <detail/parser.hpp>
+#include <djson/incremental_parser.hpp>
+#include <algorithm>
+#include <cassert>
+#include <optional>
+
+namespace dj {
+namespace {
+using detail::ParseError;
+using detail::ScanError;
+using detail::Scanner;
+using detail::Token;
+namespace token = detail::token;
+
+using ScanResult = std::expected<Token, ScanError>;
+
+/// \brief Check whether a scan at the end of (non-final) text may change once more text is appended.
+[[nodiscard]] auto is_split(ScanResult const& result, std::string_view const text) -> bool {
+	if (!result) {
+		auto const& error = result.error();
+		switch (error.type) {
+		case ScanError::Type::MissingClosingQuote:
+		case ScanError::Type::MissingEndComment: return true;
+		default: break;
+		}
+		// partial keyword / comment opener.
+		auto const rest = text.substr(error.offset);
+		if (rest == "/") { return true; }
+		return std::ranges::any_of(token::operator_str_v, [rest](std::string_view const keyword) { return rest.size() < keyword.size() && keyword.starts_with(rest); });
+	}
+
+	auto const end = result->offset + result->lexeme.size();
+	if (end < text.size()) { return false; }
+	if (result->is<token::Number>()) { return true; }
+	return result->is<token::Comment>() && result->lexeme.starts_with("//");
+}
+
+/// \brief Finds where a token split across chunks may end, looking at each appended char once (instead of rescanning the token).
+class SplitEnd {
+  public:
+	/// \brief Begin tracking the (split) token at the start of text.
+	void reset(std::string_view const text) {
+		m_carry = false;
+		if (text.starts_with('"')) {
+			m_kind = Kind::String;
+			skip(text.substr(1));
+		} else if (text.starts_with("/*")) {
+			m_kind = Kind::BlockComment;
+			skip(text.substr(2));
+		} else if (text.starts_with("//")) {
+			m_kind = Kind::LineComment;
+		} else if (!text.empty() && detail::get_char_class(text.front()).lead == detail::Lead::Number) {
+			m_kind = Kind::Number;
+		} else {
+			m_kind = Kind::Other;
+		}
+	}
+
+	[[nodiscard]] auto is_string() const -> bool { return m_kind == Kind::String; }
+
+	/// \brief Search text appended to the token for the first char that may end it.
+	/// \returns Length of text up to and including that char, npos if none.
+	[[nodiscard]] auto find(std::string_view const text) -> std::size_t {
+		switch (m_kind) {
+		case Kind::String: return find_quote(text);
+		case Kind::BlockComment: return find_end_comment(text);
+		case Kind::LineComment: return to_length(text.find('\n'));
+		case Kind::Number: {
+			auto const it = std::ranges::find_if_not(text, [](char const c) { return detail::is_part_number(c); });
+			return it == text.end() ? std::string_view::npos : std::size_t(it - text.begin()) + 1;
+		}
+		default: return text.empty() ? std::string_view::npos : 1;
+		}
+	}
+
+  private:
+	enum class Kind : std::int8_t { Other, String, BlockComment, LineComment, Number };
+
+	/// \brief Track the carry over text that does not end the token.
+	void skip(std::string_view const text) {
+		[[maybe_unused]] auto const end = find(text);
+		assert(end == std::string_view::npos);
+	}
+
+	[[nodiscard]] static auto to_length(std::size_t const index) -> std::size_t { return index == std::string_view::npos ? index : index + 1; }
+
+	// m_carry: the previous char was a backslash.
+	[[nodiscard]] auto find_quote(std::string_view const text) -> std::size_t {
+		auto index = m_carry ? 1uz : 0uz;
+		m_carry = false;
+		while (true) {
+			index = detail::simd::find_quote_or_backslash(text, index);
+			if (index >= text.size()) { return std::string_view::npos; }
+			if (text[index] == '"') { return index + 1; }
+			if (index + 1 >= text.size()) {
+				m_carry = true;
+				return std::string_view::npos;
+			}
+			index += 2;
+		}
+	}
+
+	// m_carry: the previous char was an asterisk.
+	[[nodiscard]] auto find_end_comment(std::string_view const text) -> std::size_t {
+		for (auto index = 0uz; index < text.size(); ++index) {
+			if (m_carry && text[index] == '/') { return index + 1; }
+			m_carry = text[index] == '*';
+		}
+		return std::string_view::npos;
+	}
+
+	Kind m_kind{};
+	bool m_carry{};
+};
+
+/// \brief Line / column tracking across text that has been discarded.
+struct LineTracker {
+	/// \brief Advance over text beginning at the tracked offset.
+	void skip(std::string_view const text, std::uint64_t const base) {
+		auto const last = text.rfind('\n');
+		if (last == std::string_view::npos) { return; }
+		lines += std::uint64_t(std::ranges::count(text, '\n'));
+		line_start = base + last + 1;
+	}
+
+	/// \brief Compute the line and column of an offset into text beginning at the tracked offset.
+	[[nodiscard]] auto to_src_loc(std::string_view const text, std::uint64_t const base, std::uint64_t const offset) const -> SrcLoc {
+		auto ret = *this;
+		ret.skip(text.substr(0, offset - base), base);
+		return SrcLoc{.line = ret.lines + 1, .column = offset - ret.line_start + 1};
+	}
+
+	std::uint64_t lines{};
+	std::uint64_t line_start{};
+};
+} // namespace
+
+struct IncrementalParser::Impl {
+	explicit Impl(ParseOptions const& options) : options(options), builder(options), parser(builder, options) {}
+
+	auto feed(std::string_view chunk) -> bool {
+		if (error) { return false; }
+
+		auto base = pending_offset + pending.size();
+		// text beyond the budget is not parsed (or buffered).
+		if (chunk.size() > options.max_size || base > options.max_size - chunk.size()) {
+			error = Error{.type = Error::Type::MaxSizeExceeded, .offset = options.max_size};
+			return false;
+		}
+		if (!pending.empty()) {
+			// complete the split token, copying only as much of the chunk as it needs: pending is rescanned only once it may end.
+			auto const pending_size = pending.size();
+			auto length = 0uz;
+			auto result = ScanResult{};
+			while (true) {
+				auto const end = split_end.find(chunk.substr(length));
+				if (end == std::string_view::npos) {
+					pending.append(chunk.substr(length));
+					return check_pending();
+				}
+				pending.append(chunk.substr(length, end));
+				length += end;
+				result = Scanner{pending}.next();
+				if (!is_split(result, pending)) { break; }
+				split_end.reset(pending);
+			}
+			if (!consume(result, pending, pending_offset)) { return false; }
+
+			auto const end = result->offset + result->lexeme.size();
+			lines.skip(std::string_view{pending}.substr(0, end), pending_offset);
+			chunk = chunk.substr(end - pending_size);
+			base += end - pending_size;
+		}
+
+		auto scanner = Scanner{chunk};
+		auto keep = chunk.size();
+		while (true) {
+			auto const result = scanner.next();
+			if (is_split(result, chunk)) {
+				keep = result ? result->offset : result.error().offset;
+				break;
+			}
+			if (result && result->is<token::Eof>()) { break; }
+			if (!consume(result, chunk, base)) { return false; }
+		}
+
+		lines.skip(chunk.substr(0, keep), base);
+		pending.assign(chunk.substr(keep));
+		pending_offset = base + keep;
+		split_end.reset(pending);
+		return check_pending();
+	}
+
+	/// \brief Fail if the split token is a string already longer than the budget (instead of buffering it until it ends).
+	auto check_pending() -> bool {
+		// excluding the opening quote.
+		if (!split_end.is_string() || pending.size() - 1 <= options.max_string_length) { return true; }
+		error = Error{
+			.type = Error::Type::MaxStringLengthExceeded,
+			.token = pending,
+			.src_loc = lines.to_src_loc(pending, pending_offset, pending_offset),
+			.offset = pending_offset,
+		};
+		return false;
+	}
+
+	auto finish() -> Result {
+		if (!error) {
+			auto scanner = Scanner{pending};
+			while (true) {
+				auto const result = scanner.next();
+				if (!consume(result, pending, pending_offset) || result->is<token::Eof>()) { break; }
+			}
+		}
+		if (error) { return std::unexpected(std::move(*error)); }
+		return builder.release();
+	}
+
+	/// \brief Push a scanned token into the parser.
+	/// \returns false if an error has been encountered.
+	auto consume(ScanResult const& result, std::string_view const text, std::uint64_t const base) -> bool {
+		if (!result) {
+			auto parse_error = detail::to_parse_error(result.error());
+			parse_error.offset += base;
+			error = to_error(parse_error, text, base);
+			return false;
+		}
+
+		auto token = *result;
+		token.offset += base;
+		if (deferred && !token.is<token::Comment>()) {
+			error = std::move(deferred);
+			return false;
+		}
+
+		auto const pushed = parser.push(token);
+		if (!pushed) {
+			// errors are converted immediately, text is not retained.
+			auto converted = to_error(pushed.error(), text, base);
+			if (!token.is<token::Comment>() && !token.is<token::Eof>()) {
+				deferred = std::move(converted);
+				return true;
+			}
+			error = std::move(converted);
+			return false;
+		}
+		return true;
+	}
+
+	[[nodiscard]] auto to_error(ParseError const& in, std::string_view const text, std::uint64_t const base) const -> Error {
+		return Error{
+			.type = in.type,
+			.token = std::string{in.token},
+			.src_loc = lines.to_src_loc(text, base, in.offset),
+			.offset = in.offset,
+		};
+	}
+
+	ParseOptions options{};
+	detail::JsonBuilder builder{};
+	detail::EventParser parser;
+
+	/// \brief Text of a token split across chunks.
+	std::string pending{};
+	/// \brief End of the token in pending, searched in appended text.
+	SplitEnd split_end{};
+	/// \brief Offset of pending in the whole text.
+	std::uint64_t pending_offset{};
+	/// \brief Line tracking up to pending_offset.
+	LineTracker lines{};
+
+	/// \brief Error to report once the next token has been scanned successfully.
+	std::optional<Error> deferred{};
+	std::optional<Error> error{};
+};
+
+IncrementalParser::IncrementalParser(ParseOptions const& options) : m_impl(std::make_unique<Impl>(options)) {}
+
+IncrementalParser::IncrementalParser(ParseMode const mode) : IncrementalParser(ParseOptions{.mode = mode}) {}
+
+IncrementalParser::~IncrementalParser() = default;
+
+IncrementalParser::IncrementalParser(IncrementalParser&&) noexcept = default;
+
+auto IncrementalParser::operator=(IncrementalParser&&) noexcept -> IncrementalParser& = default;
+
+auto IncrementalParser::feed(std::span<char const> const chunk) -> bool { return m_impl->feed(std::string_view{chunk.data(), chunk.size()}); }
+
+auto IncrementalParser::finish() -> Result {
+	auto ret = m_impl->finish();
+	m_impl = std::make_unique<Impl>(m_impl->options);
+	return ret;
+}
+} // namespace dj
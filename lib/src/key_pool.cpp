@@ -0,0 +1,69 @@
+#include <djson/key_pool.hpp>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace dj {
+struct KeyPool::Impl {
+	/// \brief Minimum size of each block of key text.
+	static constexpr auto block_size_v = 4096uz;
+
+	auto intern(std::string_view const text) -> std::string_view {
+		{
+			// most keys repeat: only take an exclusive lock to add new ones.
+			auto lock = std::shared_lock{mutex};
+			if (auto const it = keys.find(text); it != keys.end()) { return *it; }
+		}
+		auto lock = std::unique_lock{mutex};
+		if (auto const it = keys.find(text); it != keys.end()) { return *it; }
+		auto const ret = store(text);
+		keys.insert(ret);
+		return ret;
+	}
+
+	/// \brief Copy text into the current block, starting a new one if it does not fit.
+	/// Blocks are never reallocated, so views into them remain valid.
+	auto store(std::string_view const text) -> std::string_view {
+		if (blocks.empty() || block_used + text.size() > block_capacity) {
+			block_capacity = std::max(block_size_v, text.size());
+			blocks.push_back(std::make_unique_for_overwrite<char[]>(block_capacity));
+			block_used = 0;
+		}
+		auto* data = blocks.back().get() + block_used; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		if (!text.empty()) { std::memcpy(data, text.data(), text.size()); }
+		block_used += text.size();
+		text_size += text.size();
+		return std::string_view{data, text.size()};
+	}
+
+	mutable std::shared_mutex mutex{};
+	std::vector<std::unique_ptr<char[]>> blocks{}; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+	std::size_t block_used{};
+	std::size_t block_capacity{};
+	std::unordered_set<std::string_view> keys{};
+	std::size_t text_size{};
+};
+
+KeyPool::KeyPool() : m_impl(std::make_unique<Impl>()) {}
+
+KeyPool::~KeyPool() = default;
+
+KeyPool::KeyPool(KeyPool&&) noexcept = default;
+
+auto KeyPool::operator=(KeyPool&&) noexcept -> KeyPool& = default;
+
+auto KeyPool::intern(std::string_view const text) -> std::string_view { return m_impl->intern(text); }
+
+auto KeyPool::key_count() const -> std::size_t {
+	auto lock = std::shared_lock{m_impl->mutex};
+	return m_impl->keys.size();
+}
+
+auto KeyPool::text_size() const -> std::size_t {
+	auto lock = std::shared_lock{m_impl->mutex};
+	return m_impl->text_size;
+}
+} // namespace dj
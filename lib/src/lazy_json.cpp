@@ -0,0 +1,243 @@
+#include <detail/char_class.hpp>
+#include <detail/number.hpp>
+#include <detail/parser.hpp>
+#include <detail/structural.hpp>
+#include <detail/unescape.hpp>
+#include <djson/lazy_json.hpp>
+#include <optional>
+
+namespace dj {
+namespace {
+using detail::Token;
+namespace token = detail::token;
+
+[[nodiscard]] constexpr auto is_opening(Token const& token) {
+	return token.is_operator(token::Operator::SquareLeft) || token.is_operator(token::Operator::BraceLeft);
+}
+
+[[nodiscard]] constexpr auto is_closing(Token const& token) {
+	return token.is_operator(token::Operator::SquareRight) || token.is_operator(token::Operator::BraceRight);
+}
+
+/// \brief Walks tokens from an offset into the source text, ignoring comments.
+class Walker {
+  public:
+	explicit Walker(std::string_view const source, std::uint64_t const offset) : m_source(source), m_base(offset), m_scanner(source.substr(offset)) {}
+
+	/// \brief Obtain the next non-comment token, with offset relative to the source text.
+	[[nodiscard]] auto next() -> std::optional<Token> {
+		while (true) {
+			auto result = m_scanner.next();
+			if (!result) { return {}; }
+			if (result->is<token::Comment>()) { continue; }
+			result->offset += m_base;
+			return *result;
+		}
+	}
+
+	/// \brief Skip the rest of the value beginning with first.
+	/// \returns Offset one past the end of the value.
+	[[nodiscard]] auto skip(Token const& first) -> std::optional<std::uint64_t> {
+		auto const ret = first.offset + first.lexeme.size();
+		if (!is_opening(first)) { return ret; }
+		auto const end = detail::skip_container(m_source, ret);
+		if (!end) { return {}; }
+		*this = Walker{m_source, *end};
+		return *end;
+	}
+
+	/// \brief Locate the next member (if object) / element, after an opening bracket / comma.
+	[[nodiscard]] auto read_child(bool const is_object) -> LazyCursor {
+		auto token = next();
+		if (!token || token->is<token::Eof>() || is_closing(*token)) { return {}; }
+		auto ret = LazyCursor{};
+		if (is_object) {
+			if (!token->is<token::String>()) { return {}; }
+			ret.key = token->offset;
+			token = next();
+			if (!token || !token->is_operator(token::Operator::Colon)) { return {}; }
+			token = next();
+			if (!token || token->is<token::Eof>()) { return {}; }
+		}
+		ret.value = token->offset;
+		return ret;
+	}
+
+  private:
+	std::string_view m_source{};
+	std::uint64_t m_base{};
+	detail::Scanner m_scanner;
+};
+
+[[nodiscard]] auto matches(std::string_view const escaped, std::string_view const key) -> bool {
+	if (escaped.find('\\') == std::string_view::npos) { return escaped == key; }
+	auto unescaped = std::string{};
+	if (detail::Unescape{.in = token::String{.escaped = escaped}}(unescaped)) { return false; }
+	return unescaped == key;
+}
+
+template <typename T>
+[[nodiscard]] auto to_number(Token const& token, T const fallback) -> T {
+	auto const* number = std::get_if<token::Number>(&token.type);
+	if (!number) { return fallback; }
+	auto const payload = detail::to_number(*number);
+	if (!payload) { return fallback; }
+	return std::visit([](auto const n) { return static_cast<T>(n); }, *payload);
+}
+} // namespace
+
+auto LazyJson::parse(std::string_view const text, ParseMode mode) -> std::expected<LazyJson, Error> {
+	auto walker_mode = mode;
+	auto scanner = detail::Scanner{text};
+	auto token = scanner.next();
+	if (token && token->is<token::Comment>() && mode != ParseMode::Strict) {
+		if (mode == ParseMode::Auto) { walker_mode = detail::is_jsonc_header(token->lexeme) ? ParseMode::Jsonc : ParseMode::Strict; }
+		if (walker_mode == ParseMode::Jsonc) {
+			while (token && token->is<token::Comment>()) { token = scanner.next(); }
+		} else {
+			// Auto mode allows a single leading comment without a header: any more are errors.
+			token = scanner.next();
+		}
+	}
+	if (walker_mode == ParseMode::Auto) { walker_mode = ParseMode::Strict; }
+
+	if (!token || token->is<token::Comment>()) {
+		// the full parser fails at the same token, use it to report the error.
+		auto result = detail::Parser{text, mode}.parse();
+		if (!result) { return std::unexpected(std::move(result.error())); }
+		return LazyJson{};
+	}
+	if (token->is<token::Eof>()) { return LazyJson{}; }
+	return LazyJson{text, token->offset, walker_mode};
+}
+
+auto LazyJson::get_type() const -> Type {
+	if (m_offset >= m_source.size()) { return Type::Null; }
+	auto const& char_class = detail::get_char_class(m_source[m_offset]);
+	switch (char_class.lead) {
+	case detail::Lead::Operator: {
+		if (char_class.op == token::Operator::SquareLeft) { return Type::Array; }
+		if (char_class.op == token::Operator::BraceLeft) { return Type::Object; }
+		return Type::Null;
+	}
+	case detail::Lead::Keyword: return char_class.op == token::Operator::Null ? Type::Null : Type::Boolean;
+	case detail::Lead::Number: return Type::Number;
+	case detail::Lead::Quote: return Type::String;
+	default: return Type::Null;
+	}
+}
+
+auto LazyJson::as_bool(bool const fallback) const -> bool {
+	if (!is_boolean()) { return fallback; }
+	auto const token = Walker{m_source, m_offset}.next();
+	if (!token) { return fallback; }
+	if (token->is_operator(token::Operator::True)) { return true; }
+	if (token->is_operator(token::Operator::False)) { return false; }
+	return fallback;
+}
+
+auto LazyJson::as_double(double const fallback) const -> double {
+	if (!is_number()) { return fallback; }
+	auto const token = Walker{m_source, m_offset}.next();
+	if (!token) { return fallback; }
+	return to_number(*token, fallback);
+}
+
+auto LazyJson::as_u64(std::uint64_t const fallback) const -> std::uint64_t {
+	if (!is_number()) { return fallback; }
+	auto const token = Walker{m_source, m_offset}.next();
+	if (!token) { return fallback; }
+	return to_number(*token, fallback);
+}
+
+auto LazyJson::as_i64(std::int64_t const fallback) const -> std::int64_t {
+	if (!is_number()) { return fallback; }
+	auto const token = Walker{m_source, m_offset}.next();
+	if (!token) { return fallback; }
+	return to_number(*token, fallback);
+}
+
+auto LazyJson::as_string_view(std::string_view const fallback) const -> std::string_view {
+	if (!is_string()) { return fallback; }
+	auto const token = Walker{m_source, m_offset}.next();
+	if (!token) { return fallback; }
+	auto const* string = std::get_if<token::String>(&token->type);
+	if (!string) { return fallback; }
+	return string->escaped;
+}
+
+auto LazyJson::as_string(std::string_view const fallback) const -> std::string {
+	if (!is_string()) { return std::string{fallback}; }
+	auto const token = Walker{m_source, m_offset}.next();
+	if (!token) { return std::string{fallback}; }
+	auto const* string = std::get_if<token::String>(&token->type);
+	if (!string) { return std::string{fallback}; }
+	auto ret = std::string{};
+	ret.reserve(string->escaped.size());
+	if (detail::Unescape{.in = *string}(ret)) { return std::string{fallback}; }
+	return ret;
+}
+
+auto LazyJson::as_array() const -> LazyRange<LazyJson> {
+	if (!is_array()) { return LazyRange<LazyJson>{*this, {}}; }
+	return LazyRange<LazyJson>{*this, first_child(false)};
+}
+
+auto LazyJson::as_object() const -> LazyRange<Member> {
+	if (!is_object()) { return LazyRange<Member>{*this, {}}; }
+	return LazyRange<Member>{*this, first_child(true)};
+}
+
+auto LazyJson::operator[](std::string_view const key) const -> LazyJson {
+	if (!is_object()) { return {}; }
+	for (auto cursor = first_child(true); cursor.value != 0; cursor = next_child(cursor, true)) {
+		if (matches(at(cursor.key).as_string_view(), key)) { return at(cursor.value); }
+	}
+	return {};
+}
+
+auto LazyJson::operator[](std::size_t index) const -> LazyJson {
+	if (!is_array()) { return {}; }
+	auto cursor = first_child(false);
+	for (; cursor.value != 0 && index > 0; --index) { cursor = next_child(cursor, false); }
+	if (cursor.value == 0) { return {}; }
+	return at(cursor.value);
+}
+
+auto LazyJson::get_text() const -> std::string_view {
+	if (!*this) { return {}; }
+	auto walker = Walker{m_source, m_offset};
+	auto const first = walker.next();
+	if (!first) { return m_source.substr(m_offset); }
+	auto const end = walker.skip(*first);
+	if (!end) { return m_source.substr(m_offset); }
+	return m_source.substr(m_offset, *end - m_offset);
+}
+
+auto LazyJson::to_json() const -> Result {
+	auto result = detail::Parser{get_text(), m_mode}.parse();
+	if (!result) {
+		// locate error relative to the whole source text.
+		auto& error = result.error();
+		error.offset += m_offset;
+		error.src_loc = detail::to_src_loc(m_source, error.offset);
+	}
+	return result;
+}
+
+auto LazyJson::first_child(bool const is_object) const -> LazyCursor {
+	auto walker = Walker{m_source, m_offset};
+	auto const opening = walker.next();
+	if (!opening || !is_opening(*opening)) { return {}; }
+	return walker.read_child(is_object);
+}
+
+auto LazyJson::next_child(LazyCursor const cursor, bool const is_object) const -> LazyCursor {
+	auto walker = Walker{m_source, cursor.value};
+	auto const first = walker.next();
+	if (!first || !walker.skip(*first)) { return {}; }
+	auto const separator = walker.next();
+	if (!separator || !separator->is_operator(token::Operator::Comma)) { return {}; }
+	return walker.read_child(is_object);
+}
+} // namespace dj
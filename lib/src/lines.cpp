@@ -0,0 +1,85 @@
+#include <detail/parallel.hpp>
+#include <detail/simd.hpp>
+#include <djson/lines.hpp>
+#include <algorithm>
+#include <limits>
+#include <span>
+
+namespace dj {
+namespace {
+/// \brief Number of lines claimed by a thread at a time.
+constexpr auto grain_v = 16uz;
+
+struct Record {
+	std::string_view text{};
+	std::uint64_t offset{};
+	std::uint64_t line{};
+};
+
+/// \brief Splits text into non-blank lines.
+class LineSplitter {
+  public:
+	explicit LineSplitter(std::string_view const text) : m_text(text) {}
+
+	/// \brief Append up to max records to out.
+	/// \returns false if text has been exhausted.
+	auto next(std::vector<Record>& out, std::size_t const max) -> bool {
+		for (auto count = 0uz; count < max && m_offset < m_text.size();) {
+			auto end = m_text.find('\n', m_offset);
+			if (end == std::string_view::npos) { end = m_text.size(); }
+			auto const line = m_text.substr(m_offset, end - m_offset);
+			if (detail::simd::skip_whitespace(line) < line.size()) {
+				out.push_back(Record{.text = line, .offset = m_offset, .line = m_line});
+				++count;
+			}
+			m_offset = end + 1;
+			++m_line;
+		}
+		return m_offset < m_text.size();
+	}
+
+  private:
+	std::string_view m_text{};
+	std::uint64_t m_offset{};
+	std::uint64_t m_line{1};
+};
+
+[[nodiscard]] auto parse_record(Record const& record, ParseOptions const& options) -> ParsedLine {
+	auto ret = ParsedLine{.line = record.line, .result = Json::parse(record.text, options)};
+	if (!ret.result) {
+		// locate error relative to the whole text.
+		auto& error = ret.result.error();
+		error.offset += record.offset;
+		error.src_loc.line += record.line - 1;
+	}
+	return ret;
+}
+
+void parse_records(std::span<Record const> records, std::span<ParsedLine> out, LinesOptions const& options) {
+	detail::parallel_for(records.size(), options.threads, grain_v, [&](std::size_t const index) { out[index] = parse_record(records[index], options.parse); });
+}
+} // namespace
+
+auto parse_lines(std::string_view const text, LinesOptions const& options) -> std::vector<ParsedLine> {
+	auto records = std::vector<Record>{};
+	LineSplitter{text}.next(records, std::numeric_limits<std::size_t>::max());
+	auto ret = std::vector<ParsedLine>(records.size());
+	parse_records(records, ret, options);
+	return ret;
+}
+
+void parse_lines(std::string_view const text, LineCallback const& callback, LinesOptions const& options) {
+	auto splitter = LineSplitter{text};
+	auto const batch_size = std::max(options.batch_size, 1uz);
+	auto records = std::vector<Record>{};
+	auto lines = std::vector<ParsedLine>{};
+	records.reserve(batch_size);
+	for (auto more = true; more;) {
+		records.clear();
+		more = splitter.next(records, batch_size);
+		lines.resize(records.size());
+		parse_records(records, lines, options);
+		for (auto& line : lines) { callback(std::move(line)); }
+	}
+}
+} // namespace dj
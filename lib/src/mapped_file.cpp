@@ -0,0 +1,114 @@
+#include <detail/mapped_file.hpp>
+#include <filesystem>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DJ_MMAP_POSIX
+#endif
+
+namespace dj::detail {
+namespace fs = std::filesystem;
+
+#if defined(_WIN32)
+namespace {
+/// \brief Closes a Win32 handle on destruction.
+struct Handle {
+	Handle(Handle const&) = delete;
+	Handle(Handle&&) = delete;
+	auto operator=(Handle const&) = delete;
+	auto operator=(Handle&&) = delete;
+
+	explicit Handle(HANDLE const handle) : handle(handle) {}
+	~Handle() {
+		if (handle != nullptr && handle != INVALID_HANDLE_VALUE) { CloseHandle(handle); }
+	}
+
+	HANDLE handle{};
+};
+} // namespace
+
+auto MappedFile::map(std::string_view const path, bool const /*huge_pages*/) -> std::optional<MappedFile> {
+	auto const fs_path = fs::path{path};
+	auto const file = Handle{CreateFileW(fs_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)};
+	if (file.handle == INVALID_HANDLE_VALUE || GetFileType(file.handle) != FILE_TYPE_DISK) { return {}; }
+
+	auto size = LARGE_INTEGER{};
+	if (!GetFileSizeEx(file.handle, &size)) { return {}; }
+	if (size.QuadPart == 0) { return {}; }
+
+	auto const mapping = Handle{CreateFileMappingW(file.handle, nullptr, PAGE_READONLY, 0, 0, nullptr)};
+	if (mapping.handle == nullptr) { return {}; }
+	auto ret = MappedFile{};
+	// the view keeps the file mapping alive.
+	ret.m_data = MapViewOfFile(mapping.handle, FILE_MAP_READ, 0, 0, 0);
+	if (ret.m_data == nullptr) { return {}; }
+	ret.m_size = std::size_t(size.QuadPart);
+	return ret;
+}
+
+MappedFile::~MappedFile() {
+	if (m_data != nullptr) { UnmapViewOfFile(m_data); }
+}
+#elif defined(DJ_MMAP_POSIX)
+auto MappedFile::map(std::string_view const path, bool const huge_pages) -> std::optional<MappedFile> {
+	auto const fs_path = fs::path{path};
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+	auto const fd = ::open(fs_path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) { return {}; }
+
+	auto ret = std::optional<MappedFile>{};
+	struct stat info{};
+	// empty files are left to buffered reads: files in /proc (etc) report a size of 0, but are not empty.
+	if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+		auto const size = std::size_t(info.st_size);
+		auto* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED) {
+			::madvise(data, size, MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+			if (huge_pages) { ::madvise(data, size, MADV_HUGEPAGE); }
+#else
+			static_cast<void>(huge_pages);
+#endif
+			ret.emplace();
+			ret->m_data = data;
+			ret->m_size = size;
+		}
+	}
+	// the mapping keeps the file alive.
+	::close(fd);
+	return ret;
+}
+
+MappedFile::~MappedFile() {
+	if (m_data != nullptr) { ::munmap(m_data, m_size); }
+}
+#else
+auto MappedFile::map(std::string_view const /*path*/, bool const /*huge_pages*/) -> std::optional<MappedFile> { return {}; }
+
+MappedFile::~MappedFile() = default;
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) {}
+
+auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile& {
+	if (&other != this) {
+		auto temp = std::move(other);
+		std::swap(m_data, temp.m_data);
+		std::swap(m_size, temp.m_size);
+	}
+	return *this;
+}
+} // namespace dj::detail
@@ -0,0 +1,177 @@
+#include <detail/parallel.hpp>
+#include <detail/parser.hpp>
+#include <detail/structural.hpp>
+#include <algorithm>
+#include <optional>
+
+namespace dj::detail {
+namespace {
+/// \brief Minimum length of text in each range parsed in parallel.
+constexpr auto min_range_length_v = std::size_t{64} * 1024;
+/// \brief Number of ranges per thread, to balance uneven elements.
+constexpr auto ranges_per_thread_v = 4uz;
+
+/// \brief Range of elements (Array) / members (Object) of the top-level container.
+struct Range {
+	std::size_t begin{};
+	std::size_t end{};
+	/// \brief Number of separating commas in the range.
+	std::size_t commas{};
+};
+
+/// \brief Builds a Json from the events of a range, counting its elements / members.
+class RangeBuilder final : public EventHandler {
+  public:
+	explicit RangeBuilder(bool const is_object, ParseOptions const& options, std::string_view const text)
+		: m_builder(options, text), m_is_object(is_object) {}
+
+	void on_null() final {
+		count_value();
+		m_builder.on_null();
+	}
+	void on_bool(bool const value) final {
+		count_value();
+		m_builder.on_bool(value);
+	}
+	void on_number(ParsedNumber const& value) final {
+		count_value();
+		m_builder.on_number(value);
+	}
+	void on_string(std::string_view const value) final {
+		count_value();
+		m_builder.on_string(value);
+	}
+
+	void on_key(std::string_view const key) final {
+		if (m_depth == 1) { ++count; }
+		m_builder.on_key(key);
+	}
+
+	void begin_array() final {
+		count_value();
+		++m_depth;
+		m_builder.begin_array();
+	}
+	void end_array() final {
+		--m_depth;
+		m_builder.end_array();
+	}
+	void begin_object() final {
+		count_value();
+		++m_depth;
+		m_builder.begin_object();
+	}
+	void end_object() final {
+		--m_depth;
+		m_builder.end_object();
+	}
+
+	[[nodiscard]] auto release() -> Json { return m_builder.release(); }
+
+	std::size_t count{};
+
+  private:
+	void count_value() {
+		if (m_depth == 1 && !m_is_object) { ++count; }
+	}
+
+	JsonBuilder m_builder;
+	std::size_t m_depth{};
+	bool m_is_object{};
+};
+
+/// \brief Parse a range as if it were enclosed by the top-level container's brackets.
+/// \returns Json and the number of elements / members parsed, or nullopt on any error.
+[[nodiscard]] auto parse_range(std::string_view const text, Range const& range, bool const is_object, ParseOptions const& options)
+	-> std::optional<std::pair<Json, std::size_t>> {
+	auto builder = RangeBuilder{is_object, options, text};
+	auto parser = EventParser{builder, options};
+	auto const open = Token{.type = is_object ? token::Operator::BraceLeft : token::Operator::SquareLeft};
+	if (!parser.push(open)) { return {}; }
+
+	auto scanner = Scanner{text.substr(range.begin, range.end - range.begin)};
+	while (true) {
+		auto const token = scanner.next();
+		if (!token) { return {}; }
+		if (token->is<token::Eof>()) { break; }
+		if (!parser.push(*token)) { return {}; }
+	}
+
+	auto const close = Token{.type = is_object ? token::Operator::BraceRight : token::Operator::SquareRight};
+	if (!parser.push(close) || !parser.push(Token{})) { return {}; }
+	return std::pair{builder.release(), builder.count};
+}
+} // namespace
+
+auto Parser::parse_parallel(std::string_view const text, ParseOptions const& options) -> std::optional<Json> {
+	auto const threads = resolve_thread_count(options.threads);
+	if (threads <= 1 || text.size() < 2 * min_range_length_v) { return {}; }
+	// counts would be split across ranges, and size is checked by the serial parser.
+	if (options.max_elements != unlimited_v || options.max_nodes != unlimited_v || text.size() > options.max_size) { return {}; }
+
+	// resolve the parse mode and locate the top-level container.
+	auto resolved = options;
+	auto scanner = Scanner{text};
+	auto token = scanner.next();
+	for (auto first = true; token && token->is<token::Comment>(); first = false, token = scanner.next()) {
+		if (resolved.mode == ParseMode::Strict) { return {}; }
+		if (first && resolved.mode == ParseMode::Auto) { resolved.mode = is_jsonc_header(token->lexeme) ? ParseMode::Jsonc : ParseMode::Strict; }
+	}
+	if (resolved.mode == ParseMode::Auto) { resolved.mode = ParseMode::Strict; }
+	if (!token || !(token->is_operator(token::Operator::SquareLeft) || token->is_operator(token::Operator::BraceLeft))) { return {}; }
+	auto const is_object = token->is_operator(token::Operator::BraceLeft);
+
+	// structural pre-pass: split the container at top-level commas into ranges of similar length.
+	auto const begin = std::size_t(token->offset + 1);
+	auto const target_length = std::max(min_range_length_v, (text.size() - begin) / (threads * ranges_per_thread_v));
+	auto ranges = std::vector<Range>{};
+	auto current = Range{.begin = begin};
+	auto const end = scan_container(text, begin, [&](std::size_t const comma) {
+		if (comma - current.begin < target_length) {
+			++current.commas;
+			return;
+		}
+		current.end = comma;
+		ranges.push_back(current);
+		current = Range{.begin = comma + 1};
+	});
+	if (!end || ranges.empty()) { return {}; }
+	current.end = *end - 1;
+	ranges.push_back(current);
+
+	// only comments (in JSONC mode) may follow the container.
+	auto rest = Scanner{text.substr(*end)};
+	for (token = rest.next(); token && token->is<token::Comment>() && resolved.mode != ParseMode::Strict; token = rest.next()) {}
+	if (!token || !token->is<token::Eof>()) { return {}; }
+
+	auto results = std::vector<std::optional<std::pair<Json, std::size_t>>>(ranges.size());
+	parallel_for(ranges.size(), threads, 1, [&](std::size_t const index) { results[index] = parse_range(text, ranges[index], is_object, resolved); });
+
+	// ranges must hold one more element than commas, or as many in the last range if it ends with a trailing comma (JSONC).
+	for (auto index = 0uz; index < ranges.size(); ++index) {
+		auto const& result = results[index];
+		if (!result) { return {}; }
+		auto const expected = ranges[index].commas + 1;
+		auto const is_trailing = index + 1 == ranges.size() && resolved.mode != ParseMode::Strict && result->second + 1 == expected;
+		if (result->second != expected && !is_trailing) { return {}; }
+	}
+
+	// stitch ranges together, moving elements / members.
+	auto total = 0uz;
+	for (auto const& result : results) { total += result->second; }
+	if (is_object) {
+		auto ret = Object{};
+		ret.members.reserve(total);
+		for (auto& result : results) {
+			// duplicate keys (across ranges): the later value wins.
+			for (auto& [key, value] : std::get<Object>(result->first.get_value()->payload).members) { ret.members.insert_or_assign(std::move(key), std::move(value)); }
+		}
+		return make_json(std::move(ret));
+	}
+
+	auto ret = Array{};
+	ret.members.reserve(total);
+	for (auto& result : results) { std::ranges::move(std::get<Array>(result->first.get_value()->payload).members, std::back_inserter(ret.members)); }
+	return make_json(std::move(ret));
+}
+} // namespace dj::detail
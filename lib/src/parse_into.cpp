@@ -0,0 +1,130 @@
+#include <detail/parser.hpp>
+#include <cassert>
+#include <vector>
+
+namespace dj::detail {
+namespace {
+constexpr std::size_t scratch_capacity_v{32};
+
+/// \brief Overwrites an existing Json tree from parse events, reusing its Values, Array / Object capacity, and string buffers.
+/// Values are overwritten in document order: elements by index, members by key.
+class ReusingBuilder final : public EventHandler {
+  public:
+	explicit ReusingBuilder(Json& target, ParseOptions const& options, std::string_view const text)
+		: m_target(&target), m_strings(options, text), m_raw_numbers((options.flags & ParseFlag::RawNumbers) == ParseFlag::RawNumbers) {
+		// typical documents never grow the scratch stacks.
+		m_stack.reserve(scratch_capacity_v);
+		m_spares.reserve(scratch_capacity_v);
+	}
+
+	void on_null() final { next_slot().set_null(); }
+
+	void on_bool(bool const value) final { next_slot() = Parser::make_bool(value); }
+
+	void on_number(ParsedNumber const& value) final {
+		if (m_raw_numbers) {
+			Parser::morph<literal::Number>(next_slot()) = literal::Number::from_raw(value.raw);
+		} else {
+			next_slot() = Parser::make_number(value.payload);
+		}
+	}
+
+	void on_string(std::string_view const value) final { m_strings.assign_string(next_slot(), value); }
+
+	void on_key(std::string_view const key) final {
+		assert(!m_stack.empty() && m_stack.back().object != nullptr);
+		auto& frame = m_stack.back();
+		auto& members = frame.object->members;
+		auto it = members.find(key);
+		// duplicate keys: later members win.
+		if (it == members.end()) { it = append_member(members, key); }
+		frame.count = std::size_t(it - members.begin());
+	}
+
+	void begin_array() final {
+		auto& array = Parser::morph<Array>(next_slot());
+		m_stack.push_back(Frame{.array = &array});
+	}
+
+	void end_array() final {
+		assert(!m_stack.empty() && m_stack.back().array != nullptr);
+		auto const frame = m_stack.back();
+		m_stack.pop_back();
+		auto& members = frame.array->members;
+		members.erase(members.begin() + std::ptrdiff_t(frame.count), members.end());
+	}
+
+	void begin_object() final {
+		auto& object = Parser::morph<Object>(next_slot());
+		// members are moved back from the spare (by key) as they are parsed: the rest were not in the text.
+		auto& spare = get_spare(m_stack.size());
+		if (spare.get_allocator() == object.members.get_allocator()) {
+			// the Object takes over the spare's capacity (left by the previous Object at this depth).
+			swap(spare, object.members);
+		} else {
+			for (auto& [key, value] : object.members) { spare.try_emplace(std::move(key), std::move(value)); }
+			object.members.clear();
+		}
+		m_stack.push_back(Frame{.object = &object});
+	}
+
+	void end_object() final {
+		assert(!m_stack.empty() && m_stack.back().object != nullptr);
+		m_stack.pop_back();
+		get_spare(m_stack.size()).clear();
+	}
+
+  private:
+	/// \brief Open Array (and its number of elements so far) / Object (and the position of its current member).
+	struct Frame {
+		Array* array{};
+		Object* object{};
+		std::size_t count{};
+	};
+
+	/// \brief Obtain the Json to overwrite with the next value.
+	[[nodiscard]] auto next_slot() -> Json& {
+		if (m_stack.empty()) { return *m_target; }
+		auto& frame = m_stack.back();
+		if (frame.object != nullptr) {
+			assert(frame.count < frame.object->members.size());
+			return frame.object->members.begin()[frame.count].second;
+		}
+		auto& members = frame.array->members;
+		if (frame.count == members.size()) { members.emplace_back(); }
+		return members[frame.count++];
+	}
+
+	/// \brief Spare map of the Objects at a nesting depth: holds the members of the open one not yet parsed.
+	[[nodiscard]] auto get_spare(std::size_t const depth) -> KeyMap<Json>& {
+		while (m_spares.size() <= depth) { m_spares.emplace_back(); }
+		return m_spares[depth];
+	}
+
+	/// \brief Append a member with key to the open Object, moving it (and its value) out of the spare if present.
+	[[nodiscard]] auto append_member(KeyMap<Json>& members, std::string_view const key) -> KeyMap<Json>::iterator {
+		auto& spare = get_spare(m_stack.size() - 1);
+		auto const it = spare.find(key);
+		if (it == spare.end()) { return members.try_emplace(m_strings.make_key(key)).first; }
+		auto const ret = members.try_emplace(std::move(it->first), std::move(it->second)).first;
+		// moved from members stay in the spare until the Object is closed: match no key but an empty one, with a null value.
+		it->first = Key{};
+		m_strings.reuse_key(ret->first, key);
+		return ret;
+	}
+
+	Json* m_target{};
+	StringFactory m_strings;
+	bool m_raw_numbers{};
+	std::vector<Frame> m_stack{};
+	std::vector<KeyMap<Json>> m_spares{};
+};
+} // namespace
+
+auto Parser::parse_into(Json& target) -> std::expected<void, Error> {
+	auto builder = ReusingBuilder{target, m_options, m_text};
+	auto result = parse(builder);
+	if (!result) { target.set_null(); }
+	return result;
+}
+} // namespace dj::detail
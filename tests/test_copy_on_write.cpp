@@ -0,0 +1,147 @@
+#include <djson/json.hpp>
+#include <unit_test.hpp>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+using namespace dj;
+
+constexpr auto text_v = std::string_view{R"({"a": {"b": [1, 2, 3], "c": "a string too long to be stored inline"}, "d": [{"e": true}]})"};
+constexpr auto no_spaces_v = SerializeOptions{.flags = SerializeFlag::SortKeys | SerializeFlag::NoSpaces};
+
+// elements of an Array: equal if shared.
+[[nodiscard]] auto address_of(Json const& json) { return json.as_array().data(); }
+
+TEST(copy_on_write_share) {
+	auto const source = Json::parse(text_v);
+	ASSERT(source);
+	auto const& json = *source;
+	auto const copy = json;
+	// the whole tree is shared.
+	EXPECT(&copy["a"] == &json["a"]);
+	EXPECT(address_of(copy["a"]["b"]) == address_of(json["a"]["b"]));
+	EXPECT(copy.serialize(no_spaces_v) == json.serialize(no_spaces_v));
+}
+
+TEST(copy_on_write_path) {
+	auto const source = Json::parse(text_v);
+	ASSERT(source);
+	auto const& json = *source;
+	auto const expected = json.serialize(no_spaces_v);
+
+	auto copy = json;
+	copy["a"]["b"].push_back(4);
+	EXPECT(json.serialize(no_spaces_v) == expected);
+	EXPECT(std::as_const(copy)["a"]["b"].as_array().size() == 4);
+	// only the modified path is copied.
+	EXPECT(address_of(std::as_const(copy)["a"]["b"]) != address_of(json["a"]["b"]));
+	EXPECT(address_of(std::as_const(copy)["d"]) == address_of(json["d"]));
+	EXPECT(std::as_const(copy)["a"]["c"].as_string_view().data() == json["a"]["c"].as_string_view().data());
+
+	copy = json;
+	copy["d"][0]["e"].set_boolean(false);
+	copy["a"].insert_or_assign("f", 42);
+	copy["a"]["c"].set_string("other");
+	EXPECT(json.serialize(no_spaces_v) == expected);
+	EXPECT(std::as_const(copy)["d"][0]["e"].as_bool(true) == false);
+	EXPECT(std::as_const(copy)["a"]["f"].as<int>() == 42);
+	EXPECT(std::as_const(copy)["a"]["c"].as_string_view() == "other");
+
+	copy = json;
+	copy["a"].set_object();
+	copy["d"].set_array();
+	EXPECT(json.serialize(no_spaces_v) == expected);
+	EXPECT(copy.serialize(no_spaces_v) == R"({"a":{},"d":[]})");
+
+	// the original is modified in place once it is no longer shared.
+	auto original = Json{json};
+	auto const* data = address_of(std::as_const(original)["d"]);
+	{
+		auto const copy2 = original;
+		original["d"].push_back(1);
+		EXPECT(address_of(std::as_const(original)["d"]) != data);
+	}
+	data = address_of(std::as_const(original)["d"]);
+	original["d"][0] = 0;
+	EXPECT(address_of(std::as_const(original)["d"]) == data);
+}
+
+TEST(copy_on_write_references) {
+	auto json = Json::parse(text_v).value();
+	auto& x = json["x"];
+	auto& b = json["a"]["b"];
+	auto const snapshot = json;
+	auto const expected = snapshot.serialize(no_spaces_v);
+	// references obtained before the copy are written through into json only.
+	x = 5;
+	b[0] = 42;
+	b.push_back(4);
+	EXPECT(snapshot.serialize(no_spaces_v) == expected);
+	EXPECT(std::as_const(json)["x"].as<int>() == 5);
+	EXPECT(std::as_const(json)["a"]["b"].serialize(no_spaces_v) == "[42,2,3,4]");
+	// containers not accessed mutably are still shared.
+	EXPECT(address_of(snapshot["d"]) == address_of(std::as_const(json)["d"]));
+	EXPECT(snapshot["a"]["c"].as_string_view().data() == std::as_const(json)["a"]["c"].as_string_view().data());
+
+	auto& e = json.insert_or_assign("e", Json{}).push_back();
+	auto const snapshot2 = json;
+	e = "set";
+	EXPECT(snapshot2["e"][0].is_null());
+	EXPECT(std::as_const(json)["e"][0].as_string_view() == "set");
+}
+
+TEST(copy_on_write_pinned) {
+	auto json = Json::parse(text_v).value();
+	auto& b = json["a"]["b"];
+	b[0] = 10;
+	auto const expected = json.serialize(no_spaces_v);
+
+	// every copy of a pinned container is independent of the original.
+	auto copy = json;
+	b.push_back(4);
+	json["d"][0]["e"] = false;
+	EXPECT(copy.serialize(no_spaces_v) == expected);
+	copy["a"]["b"][1] = 20;
+	EXPECT(std::as_const(json)["a"]["b"].serialize(no_spaces_v) == "[10,2,3,4]");
+	EXPECT(std::as_const(copy)["a"]["b"].serialize(no_spaces_v) == "[10,20,3]");
+	auto const copy2 = json;
+	EXPECT(address_of(copy2["a"]["b"]) != address_of(std::as_const(json)["a"]["b"]));
+
+	// a copy of itself is no longer pinned: copies of it share again.
+	json = Json{json};
+	auto const copy3 = json;
+	EXPECT(address_of(copy3["a"]["b"]) == address_of(std::as_const(json)["a"]["b"]));
+	EXPECT(copy3.serialize(no_spaces_v) == json.serialize(no_spaces_v));
+}
+
+TEST(copy_on_write_parse_into) {
+	auto json = Json::parse(text_v).value();
+	auto const copy = json;
+	ASSERT(Json::parse_into(json, R"({"a": {"b": [5], "c": "another string too long to be inline"}})"));
+	EXPECT(copy.serialize(no_spaces_v) == Json::parse(text_v)->serialize(no_spaces_v));
+	EXPECT(std::as_const(json)["a"]["b"][0].as<int>() == 5);
+}
+
+TEST(copy_on_write_threads) {
+	auto const source = Json::parse(text_v);
+	ASSERT(source);
+	auto const expected = source->serialize(no_spaces_v);
+	auto threads = std::vector<std::jthread>{};
+	auto results = std::vector<std::string>(4);
+	for (auto& result : results) {
+		threads.emplace_back([&json = *source, &result] {
+			for (int i = 0; i < 1000; ++i) {
+				auto copy = json;
+				copy["a"]["b"].push_back(i);
+				copy["d"][0]["e"] = i;
+				if (i == 999) { result = copy.serialize(no_spaces_v); }
+			}
+		});
+	}
+	threads.clear();
+	EXPECT(source->serialize(no_spaces_v) == expected);
+	for (auto const& result : results) { EXPECT(result == R"({"a":{"b":[1,2,3,999],"c":"a string too long to be stored inline"},"d":[{"e":999}]})"); }
+}
+} // namespace
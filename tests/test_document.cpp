@@ -0,0 +1,69 @@
+#include <djson/document.hpp>
+#include <unit_test.hpp>
+#include <string>
+#include <utility>
+
+namespace {
+using namespace dj;
+
+constexpr auto sort_keys_v = SerializeOptions{.flags = SerializeFlag::SortKeys | SerializeFlag::NoSpaces};
+
+TEST(document_parse) {
+	auto text = std::string{R"({"a": [1, -2.5, true, null], "b": {"c": "text", "d!": "esc\"aped"}, "e": []})"};
+	auto result = Document::parse(text);
+	ASSERT(result);
+	auto const expected = Json::parse(text);
+	ASSERT(expected);
+
+	// the text is copied: the Document does not depend on it.
+	text.assign(text.size(), ' ');
+	auto const& root = result->root();
+	EXPECT(root.serialize(sort_keys_v) == expected->serialize(sort_keys_v));
+	EXPECT(root["b"]["d!"].as_string_view() == "esc\"aped");
+	EXPECT(root["a"].as_array().size() == 4);
+	EXPECT(result->arena_size() > 0);
+
+	// moves keep the tree in place.
+	auto moved = std::move(*result);
+	EXPECT(&moved.root() == &root);
+	EXPECT(result->root().is_null());
+}
+
+TEST(document_copy) {
+	auto document = Document::parse(R"({"list": [1, 2, 3], "name": "document"})");
+	ASSERT(document);
+
+	// copies allocate their own Values: modifying them does not affect the Document.
+	auto copy = Json{document->root()};
+	copy["list"].push_back(4);
+	copy["name"] = "copy";
+	EXPECT(document->root()["list"].as_array().size() == 3);
+	EXPECT(document->root()["name"].as_string_view() == "document");
+	EXPECT(std::as_const(copy)["list"].as_array().size() == 4);
+	EXPECT(std::as_const(copy)["name"].as_string_view() == "copy");
+}
+
+TEST(document_duplicate_keys) {
+	auto const result = Document::parse(R"({"a": [1, {"x": "y"}], "b": true, "a": {"c": 3}})");
+	ASSERT(result);
+	EXPECT(result->root()["a"]["c"].as<int>() == 3);
+	EXPECT(result->root()["b"].as_bool());
+}
+
+TEST(document_error) {
+	auto const result = Document::parse(R"({"a": [1, 2)");
+	ASSERT(!result);
+	EXPECT(result.error().type == Error::Type::MissingBracket);
+
+	// partial trees are discarded along with the arena.
+	auto const partial = Document::parse(R"([{"a": [1, "two"]}, {"b": {"c": null}, "d": [true, {"e": 1)");
+	ASSERT(!partial);
+
+	auto const options = ParseOptions{.max_size = 4};
+	auto const too_big = Document::parse("[1, 2]", options);
+	ASSERT(!too_big);
+	EXPECT(too_big.error().type == Error::Type::MaxSizeExceeded);
+
+	EXPECT(Document{}.root().is_null());
+}
+} // namespace
@@ -0,0 +1,100 @@
+#include <djson/events.hpp>
+#include <unit_test.hpp>
+#include <format>
+#include <string>
+#include <vector>
+
+namespace {
+using namespace dj;
+
+using ErrType = Error::Type;
+
+/// \brief Records events as strings, and whether string views point into the source text.
+struct Recorder : EventHandler {
+	explicit Recorder(std::string_view const source = {}) : source(source) {}
+
+	void on_null() final { events.emplace_back("null"); }
+	void on_bool(bool const value) final { events.emplace_back(value ? "true" : "false"); }
+	void on_number(ParsedNumber const& value) final { events.push_back(std::format("n:{}", value.raw)); }
+	void on_string(std::string_view const value) final {
+		events.push_back(std::format("s:{}", value));
+		in_source.push_back(is_in_source(value));
+	}
+	void on_key(std::string_view const key) final {
+		events.push_back(std::format("k:{}", key));
+		in_source.push_back(is_in_source(key));
+	}
+
+	void begin_array() final { events.emplace_back("["); }
+	void end_array() final { events.emplace_back("]"); }
+	void begin_object() final { events.emplace_back("{"); }
+	void end_object() final { events.emplace_back("}"); }
+
+	[[nodiscard]] auto is_in_source(std::string_view const str) const -> bool {
+		return std::less_equal{}(source.data(), str.data()) && std::less_equal{}(str.data() + str.size(), source.data() + source.size());
+	}
+
+	std::string_view source{};
+	std::vector<std::string> events{};
+	std::vector<bool> in_source{};
+};
+
+TEST(events_order) {
+	constexpr std::string_view text = R"({"a": [1, -2.5, true, null], "b": {"c": "d", "e\ne": "f\tf"}, "g": []})";
+	auto recorder = Recorder{text};
+	auto const result = parse_events(text, recorder);
+	ASSERT(result);
+	auto const expected = std::vector<std::string>{
+		"{", "k:a", "[", "n:1", "n:-2.5", "true", "null", "]", "k:b", "{", "k:c", "s:d", "k:e\ne", "s:f\tf", "}", "k:g", "[", "]", "}",
+	};
+	EXPECT(recorder.events == expected);
+	// escaped strings are unescaped into a buffer, others view the source text.
+	auto const expected_in_source = std::vector{true, true, true, true, false, false, true};
+	EXPECT(recorder.in_source == expected_in_source);
+}
+
+TEST(events_number) {
+	struct Handler : EventHandler {
+		void on_number(ParsedNumber const& value) final { numbers.push_back(value); }
+		std::vector<ParsedNumber> numbers{};
+	};
+	auto handler = Handler{};
+	ASSERT(parse_events("[42, -7, 1e3]", handler));
+	ASSERT(handler.numbers.size() == 3);
+	EXPECT(std::holds_alternative<std::uint64_t>(handler.numbers[0].payload) && handler.numbers[0].as<int>() == 42);
+	EXPECT(std::holds_alternative<std::int64_t>(handler.numbers[1].payload) && handler.numbers[1].as<int>() == -7);
+	EXPECT(std::holds_alternative<double>(handler.numbers[2].payload) && handler.numbers[2].as<double>() == 1000.0);
+}
+
+TEST(events_jsonc) {
+	constexpr std::string_view text = R"(// -*- jsonc -*-
+[1, /* two */ 2,]
+)";
+	auto recorder = Recorder{text};
+	ASSERT(parse_events(text, recorder));
+	EXPECT((recorder.events == std::vector<std::string>{"[", "n:1", "n:2", "]"}));
+
+	recorder.events.clear();
+	auto const result = parse_events(text, recorder, ParseMode::Strict);
+	ASSERT(!result);
+	EXPECT(result.error().type == ErrType::UnexpectedComment);
+}
+
+TEST(events_error) {
+	auto recorder = Recorder{};
+	auto result = parse_events("[1, 2", recorder);
+	ASSERT(!result);
+	EXPECT(result.error().type == ErrType::MissingBracket);
+	EXPECT((recorder.events == std::vector<std::string>{"[", "n:1", "n:2"}));
+
+	recorder.events.clear();
+	result = parse_events("[[[]]]", recorder, ParseOptions{.max_depth = 2});
+	ASSERT(!result);
+	EXPECT(result.error().type == ErrType::MaxDepthExceeded);
+
+	recorder.events.clear();
+	result = parse_events("", recorder);
+	EXPECT(result);
+	EXPECT(recorder.events.empty());
+}
+} // namespace
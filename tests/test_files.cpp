@@ -1,6 +1,7 @@
 #include <djson/json.hpp>
 #include <unit_test.hpp>
 #include <filesystem>
+#include <fstream>
 #include <print>
 #include <vector>
 
@@ -47,6 +48,24 @@ TEST(test_files) {
 		EXPECT(result);
 		if (!result) { continue; }
 		EXPECT(!result->is_null());
+
+		// memory mapped and buffered reads must be equivalent.
+		auto const buffered = dj::Json::from_file(path.string(), dj::ParseOptions{.file_flags = dj::FileFlag::None});
+		ASSERT(buffered);
+		EXPECT(buffered->serialize() == result->serialize());
 	}
 }
+
+TEST(test_files_special) {
+	EXPECT(!dj::Json::from_file(fs::temp_directory_path().string()));
+	EXPECT(!dj::Json::from_file(""));
+
+	// empty files are not mapped.
+	auto const path = fs::temp_directory_path() / "djson-test-empty.json";
+	{ auto file = std::ofstream{path}; }
+	auto const result = dj::Json::from_file(path.string());
+	fs::remove(path);
+	ASSERT(result);
+	EXPECT(result->is_null());
+}
 } // namespace
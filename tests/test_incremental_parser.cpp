@@ -0,0 +1,124 @@
+#include <djson/incremental_parser.hpp>
+#include <unit_test.hpp>
+#include <string>
+#include <string_view>
+
+namespace {
+using namespace dj;
+
+using ErrType = Error::Type;
+
+[[nodiscard]] auto parse_chunked(std::string_view const text, std::size_t const chunk_size, ParseMode const mode = ParseMode::Auto) -> Result {
+	auto parser = IncrementalParser{mode};
+	for (auto index = 0uz; index < text.size(); index += chunk_size) {
+		// copy each chunk into a temporary, as received from a socket.
+		auto const chunk = std::string{text.substr(index, chunk_size)};
+		if (!parser.feed(chunk)) { break; }
+	}
+	return parser.finish();
+}
+
+void expect_same(std::string_view const text, ParseMode const mode = ParseMode::Auto) {
+	auto const expected = Json::parse(text, mode);
+	for (auto chunk_size = 1uz; chunk_size <= text.size(); ++chunk_size) {
+		auto const result = parse_chunked(text, chunk_size, mode);
+		ASSERT(result.has_value() == expected.has_value());
+		if (expected) {
+			EXPECT(result->serialize() == expected->serialize());
+		} else {
+			EXPECT(result.error().type == expected.error().type);
+			EXPECT(result.error().token == expected.error().token);
+			EXPECT(result.error().offset == expected.error().offset);
+			EXPECT(result.error().src_loc.line == expected.error().src_loc.line);
+			EXPECT(result.error().src_loc.column == expected.error().src_loc.column);
+		}
+	}
+}
+
+TEST(incremental_parser_chunks) {
+	expect_same(R"({
+  "elements": [-2.5e3, "bar", true, false, null, 1234567890],
+  "esc\"aped": "line\nbreak \\ \"quoted\"",
+  "nested": {"empty": {}, "array": [[], [{}]]},
+  "universe": 42
+})");
+	expect_same(R"(// -*- jsonc -*-
+/* multi
+   line */ [1, // comment
+  2,])");
+	expect_same("");
+	expect_same("  \n  ");
+	expect_same("-0.5e-3");
+	expect_same(R"([1 /**/, 2 /* * / **/, "\\", "a\"b\\\"c", -12.5e+3] // end)", ParseMode::Jsonc);
+}
+
+TEST(incremental_parser_long_string) {
+	// escapes at every position relative to chunk boundaries.
+	auto text = std::string{"[\""};
+	for (int i = 0; i < 20000; ++i) { text += i % 7 == 0 ? "\\\"" : "ab"; }
+	text += "\", 1]";
+	auto const expected = Json::parse(text);
+	ASSERT(expected);
+	auto const result = parse_chunked(text, 1);
+	ASSERT(result);
+	EXPECT(result->serialize() == expected->serialize());
+
+	// a string that does not end fails once past the budget, without waiting for the rest.
+	auto parser = IncrementalParser{ParseOptions{.max_string_length = 8}};
+	auto fed = 0;
+	for (auto const c : std::string_view{"[\"0123456789abcdef"}) {
+		if (!parser.feed(std::string_view{&c, 1})) { break; }
+		++fed;
+	}
+	EXPECT(fed == 10);
+	auto error = parser.finish();
+	ASSERT(!error);
+	EXPECT(error.error().type == ErrType::MaxStringLengthExceeded);
+	EXPECT(error.error().offset == 1);
+
+	parser = IncrementalParser{ParseOptions{.max_size = 16}};
+	EXPECT(parser.feed(std::string_view{"[\"0123456789"}));
+	EXPECT(!parser.feed(std::string_view{"abcdef"}));
+	error = parser.finish();
+	ASSERT(!error);
+	EXPECT(error.error().type == ErrType::MaxSizeExceeded);
+}
+
+TEST(incremental_parser_errors) {
+	expect_same(R"({"a": [1, 2 3]})");
+	expect_same("{\n  \"a\": nul,\n  \"b\": 2\n}");
+	expect_same("[1, 2, \"unterminated]");
+	expect_same("[1, 2 /* unterminated ]");
+	expect_same("[1, 2, trux]");
+	expect_same("[1, 2, 3,]", ParseMode::Strict);
+	expect_same("[1, 2, /");
+	expect_same("[1 2 $]");
+	expect_same("[1, \"\\q\", $]");
+	expect_same("[[[1]]", ParseMode::Jsonc);
+	expect_same("{\"a\": 1} 2");
+
+	// the size budget spans chunks.
+	auto parser = IncrementalParser{ParseOptions{.max_size = 8}};
+	EXPECT(parser.feed(std::string_view{"[1, 2"}));
+	EXPECT(!parser.feed(std::string_view{", 3, 4]"}));
+	auto const result = parser.finish();
+	EXPECT(!result && result.error().type == Error::Type::MaxSizeExceeded && result.error().offset == 8);
+	EXPECT(parser.feed(std::string_view{"[1, 2]"}) && parser.finish());
+}
+
+TEST(incremental_parser_reuse) {
+	auto parser = IncrementalParser{};
+	EXPECT(parser.feed(std::string_view{"[1, "}));
+	EXPECT(!parser.feed(std::string_view{"$]"}));
+	auto result = parser.finish();
+	ASSERT(!result);
+	EXPECT(result.error().type == ErrType::UnrecognizedToken);
+	EXPECT(result.error().offset == 4);
+
+	// finish() resets the parser.
+	EXPECT(parser.feed(std::string_view{"[\"ok\"]"}));
+	result = parser.finish();
+	ASSERT(result);
+	EXPECT(result->as_array().size() == 1);
+}
+} // namespace
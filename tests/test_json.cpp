@@ -1,7 +1,10 @@
 #include <djson/json.hpp>
 #include <unit_test.hpp>
+#include <format>
 #include <print>
 #include <ranges>
+#include <string>
+#include <utility>
 
 namespace {
 TEST(json_input) {
@@ -120,4 +123,114 @@ TEST(json_oob) {
 	ASSERT(arr.size() == 2);
 	EXPECT(arr[1].as<int>() == -5);
 }
+
+TEST(json_move_child) {
+	auto json = dj::Json::parse(R"({"a": {"b": [1, 2, "a string too long to be stored inline"]}})").value();
+	json = std::move(json["a"]);
+	ASSERT(json.is_object());
+	json = std::move(json["b"]);
+	ASSERT(json.is_array() && json.as_array().size() == 3);
+	json = std::move(json[2]);
+	EXPECT(json.as_string_view() == "a string too long to be stored inline");
+
+	auto& self = json;
+	json = std::move(self);
+	EXPECT(json.as_string_view() == "a string too long to be stored inline");
+}
+
+TEST(json_inline_storage) {
+	static_assert(sizeof(dj::Json) == 16);
+
+	auto json = dj::Json{"short"};
+	EXPECT(json.is_string() && json.as_string_view() == "short");
+	auto const long_text = std::string(64, 'x');
+	json.set_string(long_text);
+	EXPECT(json.as_string_view() == long_text);
+	json.set_string("fourteen chars");
+	EXPECT(json.as_string_view() == "fourteen chars");
+	json.set_string("fifteen chars!!");
+	EXPECT(json.as_string_view() == "fifteen chars!!");
+
+	json.set_string(long_text);
+	auto copy = json;
+	EXPECT(copy.as_string_view() == long_text);
+	EXPECT(copy.as_string_view().data() == json.as_string_view().data());
+	copy.set_string("other");
+	EXPECT(json.as_string_view() == long_text);
+
+	json = -42;
+	EXPECT(json.is_number() && json.as<int>() == -42);
+	json = 42u;
+	EXPECT(json.as<std::uint64_t>() == 42);
+	json = 0.5;
+	EXPECT(json.as<double>() == 0.5);
+	json = true;
+	EXPECT(json.is_boolean() && json.as_bool());
+	json.push_back("element");
+	EXPECT(json.is_array() && json.as_array().size() == 1);
+	json = nullptr;
+	EXPECT(json.is_null());
+
+	auto const parsed = dj::Json::parse(R"(["a", "escaped \n", 1.5, -1, 18446744073709551615, false, null])");
+	ASSERT(parsed);
+	EXPECT(std::as_const(*parsed)[1].as_string_view() == "escaped \n");
+	EXPECT(parsed->serialize(dj::SerializeOptions{.flags = dj::SerializeFlag::NoSpaces}).ends_with(R"(,1.5,-1,18446744073709551615,false,null])"));
+}
+
+[[nodiscard]] auto make_records(std::size_t const count, bool const is_object) {
+	auto ret = std::string{is_object ? "{" : "["};
+	for (auto i = 0uz; i < count; ++i) {
+		if (i > 0) { ret += ",\n"; }
+		if (is_object) { std::format_to(std::back_inserter(ret), R"("key{}": )", i % (count / 2)); }
+		std::format_to(std::back_inserter(ret), R"({{"id": {}, "name": "item, {{{}}}", "tags": [1, [2], {{"x": "]"}}]}})", i, i);
+	}
+	ret += is_object ? "}" : "]";
+	return ret;
+}
+
+void expect_parallel(std::string_view const text, dj::ParseMode const mode = dj::ParseMode::Auto) {
+	auto const serial = dj::Json::parse(text, mode);
+	auto const parallel = dj::Json::parse(text, dj::ParseOptions{.mode = mode, .threads = 4});
+	ASSERT(serial.has_value() == parallel.has_value());
+	if (serial) {
+		EXPECT(parallel->serialize() == serial->serialize());
+	} else {
+		EXPECT(parallel.error().type == serial.error().type);
+		EXPECT(parallel.error().offset == serial.error().offset);
+		EXPECT(parallel.error().src_loc.line == serial.error().src_loc.line);
+		EXPECT(parallel.error().src_loc.column == serial.error().src_loc.column);
+	}
+}
+
+TEST(json_parse_parallel) {
+	auto text = make_records(10'000, false);
+	auto const json = dj::Json::parse(text, dj::ParseOptions{.threads = 4});
+	ASSERT(json);
+	ASSERT(json->as_array().size() == 10'000);
+	EXPECT((*json)[9'999]["id"].as<int>() == 9'999);
+	expect_parallel(text);
+
+	// duplicate keys: later members win.
+	expect_parallel(make_records(10'000, true));
+
+	// trailing comma.
+	text.insert(text.size() - 1, ",");
+	expect_parallel(text, dj::ParseMode::Jsonc);
+	expect_parallel(text, dj::ParseMode::Strict);
+
+	// errors, located in the whole text.
+	text = make_records(10'000, false);
+	text.insert(text.size() / 2, "$");
+	expect_parallel(text);
+	text = make_records(10'000, false);
+	auto const comma = text.find(',', text.size() / 2);
+	text.insert(comma, ",");
+	expect_parallel(text, dj::ParseMode::Jsonc);
+
+	// borrowed strings.
+	text = make_records(10'000, false);
+	auto const borrowed = dj::Json::parse(text, dj::ParseOptions{.threads = 4, .flags = dj::ParseFlag::BorrowStrings});
+	ASSERT(borrowed);
+	EXPECT(borrowed->serialize() == dj::Json::parse(text)->serialize());
+}
 } // namespace
@@ -0,0 +1,96 @@
+#include <djson/json.hpp>
+#include <djson/key_map.hpp>
+#include <unit_test.hpp>
+#include <format>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+using namespace dj;
+
+constexpr auto no_spaces_v = SerializeOptions{.flags = SerializeFlag::NoSpaces};
+
+[[nodiscard]] auto make_object(std::size_t const count) -> std::string {
+	auto ret = std::string{"{"};
+	for (auto i = count; i > 0; --i) {
+		if (i < count) { ret += ','; }
+		std::format_to(std::back_inserter(ret), R"("key{}":{})", i, i);
+	}
+	ret += '}';
+	return ret;
+}
+
+TEST(key_map_flat_and_indexed) {
+	for (auto const count : {3uz, KeyMap<int>::flat_size_v, KeyMap<int>::flat_size_v + 1, 1000uz}) {
+		auto map = KeyMap<int>{};
+		for (auto i = 0uz; i < count; ++i) {
+			auto const [it, inserted] = map.try_emplace(std::format("key{}", i), int(i));
+			EXPECT(inserted && it->second == int(i));
+		}
+		ASSERT(map.size() == count);
+		for (auto i = 0uz; i < count; ++i) {
+			auto const key = std::format("key{}", i);
+			ASSERT(map.contains(key));
+			EXPECT(map.find(key)->second == int(i));
+			// insertion order.
+			EXPECT(map.begin()[i].first.view() == key);
+		}
+		EXPECT(!map.contains("key"));
+		EXPECT(map.find("absent") == map.end());
+
+		// existing keys retain their position.
+		EXPECT(!map.try_emplace("key0", -1).second);
+		EXPECT(!map.insert_or_assign("key0", -2).second);
+		EXPECT(map.begin()->second == -2 && map.size() == count);
+
+		map.clear();
+		EXPECT(map.empty() && !map.contains("key0"));
+		EXPECT(map.try_emplace("key0", 0).second && map.size() == 1);
+	}
+
+	auto const view = KeyMapView<int>{};
+	EXPECT(view.empty() && view.begin() == view.end() && !view.contains("key"));
+}
+
+TEST(key_map_json_order) {
+	for (auto const count : {4uz, 100uz}) {
+		auto const text = make_object(count);
+		auto const json = Json::parse(text);
+		ASSERT(json);
+		EXPECT(json->serialize(no_spaces_v) == text);
+		EXPECT(json->as_object().size() == count);
+		EXPECT((*json)["key1"].as<int>() == 1);
+		EXPECT(json->as_object().contains(std::format("key{}", count)));
+
+		auto const parallel = Json::parse(text, ParseOptions{.threads = 4});
+		ASSERT(parallel);
+		EXPECT(parallel->serialize(no_spaces_v) == text);
+	}
+
+	// duplicate keys: the later value, at the position of the first.
+	auto const json = Json::parse(R"({"b": 1, "a": 2, "b": 3})");
+	ASSERT(json);
+	EXPECT(json->serialize(no_spaces_v) == R"({"b":3,"a":2})");
+	EXPECT(json->serialize(SerializeOptions{.flags = SerializeFlag::SortKeys | SerializeFlag::NoSpaces}) == R"({"a":2,"b":3})");
+
+	auto built = Json{};
+	built["z"] = 1;
+	built.insert_or_assign("y", 2);
+	built["x"] = 3;
+	built.insert_or_assign("z", 4);
+	EXPECT(built.serialize(no_spaces_v) == R"({"z":4,"y":2,"x":3})");
+	EXPECT(Json{}.as_object().empty());
+}
+
+TEST(key_map_parse_into) {
+	auto json = Json{};
+	ASSERT(Json::parse_into(json, make_object(100)));
+	// reversed order, fewer keys, and duplicates.
+	auto const text = std::string_view{R"({"key1":1,"key50":50,"new":0,"key100":100,"key1":-1})"};
+	ASSERT(Json::parse_into(json, text));
+	EXPECT(json.serialize(no_spaces_v) == R"({"key1":-1,"key50":50,"new":0,"key100":100})");
+	ASSERT(Json::parse_into(json, make_object(100)));
+	EXPECT(json.serialize(no_spaces_v) == make_object(100));
+}
+} // namespace
@@ -0,0 +1,60 @@
+#include <djson/json.hpp>
+#include <djson/lines.hpp>
+#include <unit_test.hpp>
+#include <format>
+#include <string>
+
+namespace {
+using namespace dj;
+
+TEST(key_pool_intern) {
+	auto pool = KeyPool{};
+	auto const a = pool.intern("key");
+	auto const b = pool.intern(std::string{"key"});
+	EXPECT(a == "key" && a.data() == b.data());
+	EXPECT(pool.intern("other") == "other");
+	EXPECT(pool.intern("").empty());
+	EXPECT(pool.key_count() == 3);
+	EXPECT(pool.text_size() == 8);
+
+	// keys longer than a block are interned as well.
+	auto const long_key = std::string(10000, 'x');
+	EXPECT(pool.intern(long_key) == long_key);
+	EXPECT(pool.intern("key").data() == a.data());
+
+	// interned views survive moves of the pool.
+	auto moved = std::move(pool);
+	EXPECT(moved.intern("key").data() == a.data());
+}
+
+TEST(key_pool_parse) {
+	auto pool = KeyPool{};
+	auto const options = ParseOptions{.key_pool = &pool};
+	auto const text = std::string{R"([{"id": 1, "name": "a"}, {"id": 2, "name": "b"}, {"name": "c"}])"};
+	auto result = Json::parse(text, options);
+	ASSERT(result);
+	auto const& json = *result;
+	EXPECT(pool.key_count() == 2);
+
+	// identical keys share storage, including unescaped ones.
+	auto const key_data = [&json](std::size_t const index, std::string_view const key) { return json[index].as_object().find(key)->first.view().data(); };
+	EXPECT(key_data(0, "name") == key_data(1, "name"));
+	EXPECT(key_data(0, "name") == key_data(2, "name"));
+	EXPECT(key_data(0, "id") == key_data(1, "id"));
+	EXPECT(json[1]["name"].as_string_view() == "b");
+
+	// the pool is reused by successive parses.
+	auto const second = Json::parse(R"({"id": 3})", options);
+	ASSERT(second);
+	EXPECT(second->as_object().find("id")->first.view().data() == key_data(0, "id"));
+	EXPECT(pool.key_count() == 2);
+
+	// and shared by concurrent ones.
+	auto lines = std::string{};
+	for (auto i = 0; i < 500; ++i) { std::format_to(std::back_inserter(lines), "{{\"id\": {}, \"k{}\": true}}\n", i, i % 10); }
+	auto const parsed = parse_lines(lines, LinesOptions{.parse = options, .threads = 4});
+	ASSERT(parsed.size() == 500);
+	EXPECT(parsed[0].result && (*parsed[0].result)["k0"].as_bool());
+	EXPECT(pool.key_count() == 12);
+}
+} // namespace
@@ -0,0 +1,143 @@
+#include <djson/lazy_json.hpp>
+#include <unit_test.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+using namespace dj;
+
+using ErrType = Error::Type;
+
+constexpr auto text_v = R"({
+  "skipped": {"nested": [[1, 2], {"a": "]"}], "s": "}"},
+  "elements": [-2.5e3, "bar", true, null, [], {}],
+  "esc\"aped": "line\nbreak",
+  "universe": 42
+})";
+
+[[nodiscard]] auto expect_lazy(std::string_view const text, ParseMode const mode = ParseMode::Auto) {
+	auto result = LazyJson::parse(text, mode);
+	ASSERT(result);
+	return *result;
+}
+
+TEST(lazy_json_navigate) {
+	auto const json = expect_lazy(text_v);
+	EXPECT(json.is_object());
+
+	auto const universe = json["universe"];
+	EXPECT(universe.is_number());
+	EXPECT(universe.as<int>() == 42);
+	EXPECT(json["nonexistent"].is_null());
+
+	auto const elements = json["elements"];
+	EXPECT(elements.is_array());
+	EXPECT(elements[0].as<double>() == -2500.0);
+	EXPECT(elements[1].as_string_view() == "bar");
+	EXPECT(elements[2].as_bool());
+	EXPECT(elements[3].is_null());
+	EXPECT(elements[4].is_array() && elements[4].as_array().empty());
+	EXPECT(elements[5].is_object() && elements[5].as_object().empty());
+	EXPECT(elements[6].is_null());
+	EXPECT(!elements[6]);
+
+	EXPECT(json["skipped"]["nested"][1]["a"].as_string_view() == "]");
+	EXPECT(json["skipped"]["s"].as_string_view() == "}");
+}
+
+TEST(lazy_json_escaped) {
+	auto const json = expect_lazy(text_v);
+	auto const value = json["esc\"aped"];
+	EXPECT(value.is_string());
+	EXPECT(value.as_string_view() == R"(line\nbreak)");
+	EXPECT(value.as_string() == "line\nbreak");
+}
+
+TEST(lazy_json_iterate) {
+	auto const json = expect_lazy(text_v);
+
+	auto keys = std::vector<std::string_view>{};
+	for (auto const& [key, value] : json.as_object()) { keys.push_back(key); }
+	auto const expected_keys = std::vector<std::string_view>{"skipped", "elements", R"(esc\"aped)", "universe"};
+	EXPECT(keys == expected_keys);
+
+	auto types = std::vector<JsonType>{};
+	for (auto const element : json["elements"].as_array()) { types.push_back(element.get_type()); }
+	auto const expected_types = std::vector{JsonType::Number, JsonType::String, JsonType::Boolean, JsonType::Null, JsonType::Array, JsonType::Object};
+	EXPECT(types == expected_types);
+
+	// type mismatch
+	EXPECT(json.as_array().empty());
+	EXPECT(json["universe"].as_object().empty());
+}
+
+TEST(lazy_json_text) {
+	auto const json = expect_lazy(text_v);
+	EXPECT(json["skipped"]["nested"].get_text() == R"([[1, 2], {"a": "]"}])");
+	EXPECT(json["universe"].get_text() == "42");
+
+	auto const result = json["skipped"].to_json();
+	ASSERT(result);
+	EXPECT(result->is_object());
+	EXPECT(result->operator[]("nested")[0][1].as<int>() == 2);
+}
+
+TEST(lazy_json_jsonc) {
+	constexpr auto text = R"(// -*- jsonc -*-
+{
+  /* comment */ "a": [1, 2, /* skipped */ 3,],
+  "b": "c", // trailing ]
+  "d": [/* ] */ 4], "e": 5
+})";
+	auto const json = expect_lazy(text);
+	auto const a = json["a"];
+	auto count = 0;
+	for (auto const element : a.as_array()) { count += element.as<int>(); }
+	EXPECT(count == 6);
+	EXPECT(json["b"].as_string() == "c");
+	EXPECT(json["e"].as<int>() == 5);
+	EXPECT(json["a"].to_json());
+
+	// a single leading comment without a header is allowed in Auto mode.
+	auto const commented = expect_lazy("// hi\n{\"a\": 1}");
+	EXPECT(commented["a"].as<int>() == 1);
+	auto const block = expect_lazy("/* c */ []");
+	EXPECT(block.is_array());
+	EXPECT(!LazyJson::parse("// one\n// two\n[]"));
+}
+
+TEST(lazy_json_errors) {
+	auto result = LazyJson::parse("/* comment */ {}", ParseMode::Strict);
+	ASSERT(!result);
+	EXPECT(result.error().type == ErrType::UnexpectedComment);
+
+	result = LazyJson::parse("$");
+	ASSERT(!result);
+	EXPECT(result.error().type == ErrType::UnrecognizedToken);
+
+	auto const empty = expect_lazy("  ");
+	EXPECT(!empty);
+	EXPECT(empty.is_null());
+
+	// malformed values are only reported by to_json(), relative to the whole text.
+	auto const json = expect_lazy("{\n  \"a\": 1,\n  \"b\": [2, $]\n}");
+	EXPECT(json["a"].as<int>() == 1);
+	EXPECT(json["b"][0].as<int>() == 2);
+	EXPECT(json["b"][1].is_null());
+	auto const error = json["b"].to_json();
+	ASSERT(!error);
+	EXPECT(error.error().type == ErrType::UnrecognizedToken);
+	EXPECT(error.error().offset == 23);
+	EXPECT(error.error().src_loc.line == 3);
+	EXPECT(error.error().src_loc.column == 12);
+
+	// truncated subtree: end of text located in the whole text.
+	auto const truncated = expect_lazy(R"({"a": [1, )");
+	auto const eof = truncated["a"].to_json();
+	ASSERT(!eof);
+	EXPECT(eof.error().type == ErrType::UnexpectedEof);
+	EXPECT(eof.error().offset == 10);
+	EXPECT(eof.error().src_loc.line == 1);
+	EXPECT(eof.error().src_loc.column == 11);
+}
+} // namespace
@@ -0,0 +1,59 @@
+#include <djson/lines.hpp>
+#include <unit_test.hpp>
+#include <format>
+#include <string>
+
+namespace {
+using namespace dj;
+
+using ErrType = Error::Type;
+
+constexpr auto text_v = R"({"id": 1, "name": "first"}
+[1, 2, 3]
+
+  "string"
+{"id": 4, "bad": $}
+  
+42)";
+
+TEST(lines_parse) {
+	auto const lines = parse_lines(text_v, LinesOptions{.threads = 2});
+	ASSERT(lines.size() == 5);
+	EXPECT(lines[0].line == 1 && lines[0].result && (*lines[0].result)["name"].as_string_view() == "first");
+	EXPECT(lines[1].line == 2 && lines[1].result && lines[1].result->as_array().size() == 3);
+	EXPECT(lines[2].line == 4 && lines[2].result && lines[2].result->as_string_view() == "string");
+	EXPECT(lines[4].line == 7 && lines[4].result && lines[4].result->as<int>() == 42);
+
+	ASSERT(lines[3].line == 5 && !lines[3].result);
+	auto const& error = lines[3].result.error();
+	EXPECT(error.type == ErrType::UnrecognizedToken);
+	EXPECT(error.src_loc.line == 5 && error.src_loc.column == 18);
+	EXPECT(std::string_view{text_v}.substr(error.offset, 1) == "$");
+}
+
+TEST(lines_order) {
+	auto text = std::string{};
+	for (auto i = 0; i < 1000; ++i) { std::format_to(std::back_inserter(text), "{{\"i\": {}}}\r\n", i); }
+
+	auto const lines = parse_lines(text, LinesOptions{.threads = 4});
+	ASSERT(lines.size() == 1000);
+	auto ordered = true;
+	for (auto i = 0uz; i < lines.size(); ++i) {
+		ordered = ordered && lines[i].line == i + 1 && lines[i].result && (*lines[i].result)["i"].as<std::size_t>() == i;
+	}
+	EXPECT(ordered);
+
+	// streaming: same results, in order, batch_size at a time.
+	auto count = 0uz;
+	ordered = true;
+	parse_lines(
+		text,
+		[&](ParsedLine const& line) {
+			ordered = ordered && line.result && (*line.result)["i"].as<std::size_t>() == count;
+			++count;
+		},
+		LinesOptions{.threads = 3, .batch_size = 64});
+	EXPECT(count == 1000);
+	EXPECT(ordered);
+}
+} // namespace
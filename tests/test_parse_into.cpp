@@ -0,0 +1,133 @@
+#include <djson/json.hpp>
+#include <unit_test.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <format>
+#include <new>
+#include <string>
+#include <utility>
+
+namespace {
+std::atomic<std::size_t> g_allocations{};
+} // namespace
+
+auto operator new(std::size_t const size) -> void* {
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (auto* ret = std::malloc(size == 0 ? 1 : size)) { return ret; }
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t /*size*/) noexcept { std::free(ptr); }
+
+// std::pmr::new_delete_resource() (Arrays and Objects) allocates aligned.
+auto operator new(std::size_t const size, std::align_val_t const align) -> void* {
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	auto const alignment = std::max(std::size_t(align), sizeof(void*));
+	if (auto* ret = std::aligned_alloc(alignment, (std::max(size, std::size_t{1}) + alignment - 1) / alignment * alignment)) { return ret; }
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr, std::align_val_t /*align*/) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t /*size*/, std::align_val_t /*align*/) noexcept { std::free(ptr); }
+
+namespace {
+using namespace dj;
+
+constexpr auto sort_keys_v = SerializeOptions{.flags = SerializeFlag::SortKeys | SerializeFlag::NoSpaces};
+
+auto expect_equivalent(Json const& json, std::string_view const text) -> bool {
+	auto const expected = Json::parse(text);
+	if (!expected) { return false; }
+	return json.serialize(sort_keys_v) == expected->serialize(sort_keys_v);
+}
+
+auto make_records(int const offset) -> std::string {
+	auto ret = std::string{"["};
+	for (int i = 0; i < 64; ++i) {
+		if (i > 0) { ret += ','; }
+		ret += std::format(R"({{"id":{},"name":"record number {}","tags":["a","b"],"valid":{}}})", i + offset, 1000 + i + offset, i % 2 == 0 ? "true" : "false");
+	}
+	ret += ']';
+	return ret;
+}
+
+TEST(parse_into_reuse) {
+	auto const first = make_records(0);
+	auto const second = make_records(100);
+
+	auto json = Json{};
+	ASSERT(Json::parse_into(json, first));
+	EXPECT(expect_equivalent(json, first));
+
+	// same shape: only the parser's scratch stacks allocate, independent of the size of the document.
+	auto const before = g_allocations.load();
+	ASSERT(Json::parse_into(json, second));
+	auto const reused = g_allocations.load() - before;
+	EXPECT(reused <= 8);
+	EXPECT(expect_equivalent(json, second));
+
+	auto const fresh_before = g_allocations.load();
+	ASSERT(Json::parse(second));
+	auto const fresh = g_allocations.load() - fresh_before;
+	EXPECT(fresh > 64 * 4);
+}
+
+TEST(parse_into_shapes) {
+	auto json = Json{};
+	ASSERT(Json::parse_into(json, R"({"a": [1, 2, 3], "b": {"x": 1, "y": 2}, "c": "text"})"));
+
+	// fewer elements, removed and added keys, changed types.
+	auto const text = std::string_view{R"({"a": [true], "b": {"y": "two", "z": null}, "d": [[], {}]})"};
+	ASSERT(Json::parse_into(json, text));
+	EXPECT(expect_equivalent(json, text));
+	EXPECT(!json.as_object().contains("c"));
+	EXPECT(!std::as_const(json)["b"].as_object().contains("x"));
+	EXPECT(std::as_const(json)["a"].as_array().size() == 1);
+
+	// more elements.
+	auto const more = std::string_view{R"({"a": [1, 2, 3, 4, 5], "b": 42})"};
+	ASSERT(Json::parse_into(json, more));
+	EXPECT(expect_equivalent(json, more));
+
+	// scalar root.
+	ASSERT(Json::parse_into(json, "\"root\""));
+	EXPECT(json.as_string_view() == "root");
+}
+
+TEST(parse_into_duplicate_keys) {
+	auto json = Json{};
+	ASSERT(Json::parse_into(json, R"({"a": 1, "b": 2})"));
+	ASSERT(Json::parse_into(json, R"({"a": 1, "b": 2, "a": {"c": 3}})"));
+	EXPECT(std::as_const(json)["a"]["c"].as<int>() == 3);
+	EXPECT(std::as_const(json)["b"].as<int>() == 2);
+}
+
+TEST(parse_into_borrow_strings) {
+	auto json = Json{};
+	auto const first = std::string{R"({"key": "value"})"};
+	auto const options = ParseOptions{.flags = ParseFlag::BorrowStrings};
+	ASSERT(Json::parse_into(json, first, options));
+	EXPECT(std::as_const(json)["key"].as_string_view().data() == first.data() + 9);
+
+	// strings (and keys) re-point into the new text.
+	auto const second = std::string{R"({"key": "other"})"};
+	ASSERT(Json::parse_into(json, second, options));
+	EXPECT(std::as_const(json)["key"].as_string_view() == "other");
+	EXPECT(std::as_const(json)["key"].as_string_view().data() == second.data() + 9);
+
+	// owned again without the flag.
+	ASSERT(Json::parse_into(json, first));
+	EXPECT(std::as_const(json)["key"].as_string_view() == "value");
+	EXPECT(std::as_const(json)["key"].as_string_view().data() != first.data() + 9);
+}
+
+TEST(parse_into_error) {
+	auto json = Json{};
+	ASSERT(Json::parse_into(json, "[1, 2]"));
+	auto const result = Json::parse_into(json, "[1, 2");
+	EXPECT(!result);
+	EXPECT(json.is_null());
+}
+} // namespace
@@ -24,6 +24,12 @@ using ErrType = Error::Type;
 	return result.error();
 }
 
+[[nodiscard]] auto make_nested(std::size_t const depth) {
+	auto ret = std::string(depth, '[');
+	ret.append(depth, ']');
+	return ret;
+}
+
 TEST(parser_null) {
 	auto json = expect_json("");
 	EXPECT(json.is_null());
@@ -75,6 +81,23 @@ TEST(parser_number) {
 	json = expect_json(str);
 	EXPECT(json.is_number());
 	EXPECT(json.as_i64() == ilarge_v);
+
+	// integers out of range fall back to double.
+	json = expect_json("18446744073709551616");
+	EXPECT(json.is_number());
+	EXPECT(json.as_double() == 18446744073709551616.0);
+	json = expect_json("-9223372036854775809");
+	EXPECT(json.as_double() == -9223372036854775809.0);
+
+	// exact fast path, and correctly rounded slow path.
+	EXPECT(expect_json("0.1").as_double() == 0.1);
+	EXPECT(expect_json("-1.5e-3").as_double() == -1.5e-3);
+	EXPECT(expect_json("1e22").as_double() == 1e22);
+	EXPECT(expect_json("1e23").as_double() == 1e23);
+	EXPECT(expect_json("9007199254740993").as_u64() == 9007199254740993);
+	EXPECT(expect_json("9007199254740993.0").as_double() == 9007199254740992.0);
+	EXPECT(expect_json("2.2250738585072014e-308").as_double() == 2.2250738585072014e-308);
+	EXPECT(expect_json("-0").as_i64() == 0 && expect_json("0e5").as_double() == 0.0);
 }
 
 TEST(parser_string) {
@@ -91,8 +114,7 @@ TEST(parser_string) {
 
 	json = expect_json(R"("exx\btra\nnewline\\\/\"")");
 	EXPECT(json.is_string());
-	EXPECT(json.as_string_view() == R"(extra
-newline\/")");
+	EXPECT(json.as_string_view() == "exx\btra\nnewline\\/\"");
 }
 
 TEST(parser_array) {
@@ -114,6 +136,13 @@ TEST(parser_array) {
 	EXPECT(json[1].as_object().empty());
 	EXPECT(json[2].is_string());
 	EXPECT(json[2].as_string_view() == "hi");
+
+	// members of nested containers stay with their own container.
+	json = expect_json(R"([1, [2, [3, 4], 5], {"a": [6]}, 7])");
+	EXPECT(json.as_array().size() == 4);
+	EXPECT(json[1].as_array().size() == 3 && json[1][1].as_array().size() == 2 && json[1][2].as<int>() == 5);
+	EXPECT(json[2]["a"].as_array().size() == 1 && json[2]["a"][0].as<int>() == 6);
+	EXPECT(json[3].as<int>() == 7);
 }
 
 TEST(parser_object) {
@@ -129,6 +158,12 @@ TEST(parser_object) {
 	EXPECT(json.as_object().size() == 2);
 	EXPECT(json["foo"].as_string_view() == "bar");
 	EXPECT(json["pi"].as<double>() == 3.14);
+
+	// duplicate keys: later members win.
+	json = expect_json(R"({"a": 1, "b": {"a": 2, "c": 3}, "a": 4})");
+	EXPECT(json.as_object().size() == 2);
+	EXPECT(json["a"].as<int>() == 4);
+	EXPECT(json["b"].as_object().size() == 2 && json["b"]["a"].as<int>() == 2);
 }
 
 TEST(parser_jsonc) {
@@ -170,10 +205,19 @@ TEST(parser_unexpected_token) {
 	auto error = expect_error(R"(42 true)");
 	EXPECT(error.type == ErrType::UnexpectedToken);
 	EXPECT(error.src_loc.line == 1 && error.src_loc.column == 4);
+	EXPECT(error.offset == 3);
 	EXPECT(error.token == "true");
 	std::println("{}", to_string(error));
 }
 
+TEST(parser_leading_whitespace) {
+	auto error = expect_error("\n\n  [1, $]");
+	EXPECT(error.type == ErrType::UnrecognizedToken);
+	EXPECT(error.src_loc.line == 3 && error.src_loc.column == 7);
+	EXPECT(error.offset == 8);
+	std::println("{}", to_string(error));
+}
+
 TEST(parser_unexpected_comment) {
 	auto error = expect_error(R"(	42 
 // unexpected comment
@@ -199,6 +243,11 @@ TEST(parser_invalid_number) {
 	EXPECT(error.src_loc.line == 1 && error.src_loc.column == 1);
 	EXPECT(error.token == "1.2e4e5");
 	std::println("{}", to_string(error));
+
+	// JSON number grammar: no leading zeros, digits required around '.' and after exponent.
+	for (auto const text : {"01", "-01", "00", "1.", "-.5", "1.e3", "1e", "1e+", "--1", "1-2", "0.5.5"}) {
+		EXPECT(expect_error(text).type == ErrType::InvalidNumber);
+	}
 }
 
 TEST(parser_invalid_escape) {
@@ -207,6 +256,70 @@ TEST(parser_invalid_escape) {
 	EXPECT(error.src_loc.line == 1 && error.src_loc.column == 1);
 	EXPECT(error.token == R"("\xbar")");
 	std::println("{}", to_string(error));
+
+	// lone / unpaired surrogates, invalid / truncated hex digits.
+	for (auto const text : {R"("\ud83d")", R"("\ude04")", R"("\ud83d\u0041")", R"("\ud83dx")", R"("\u00g1")", R"("\u12")"}) {
+		EXPECT(expect_error(text).type == ErrType::InvalidEscape);
+	}
+}
+
+TEST(parser_unicode_escape) {
+	EXPECT(expect_json(R"("\u0041")").as_string_view() == "A");
+	EXPECT(expect_json(R"("caf\u00e9")").as_string_view() == "caf\xc3\xa9");
+	EXPECT(expect_json(R"("\u20AC 5")").as_string_view() == "\xe2\x82\xac 5");
+	EXPECT(expect_json(R"("\uD83D\uDE04")").as_string_view() == "\xf0\x9f\x98\x84");
+	EXPECT(expect_json(R"({"\u006bey": 1})")["key"].as_i64() == 1);
+
+	// backspace and form feed are characters (U+0008, U+000C), not edits.
+	EXPECT(expect_json(R"("a\bb\fc")").as_string_view() == "a\bb\fc");
+	EXPECT(expect_json(R"("\u00e9\b")").as_string_view() == "\xc3\xa9\b");
+
+	// long runs between escapes are copied in bulk.
+	auto const run = std::string(100, 'x');
+	auto const text = std::format(R"("{}\n{}\u0041{}\t")", run, run, run);
+	EXPECT(expect_json(text).as_string_view() == std::format("{}\n{}A{}\t", run, run, run));
+}
+
+TEST(parser_invalid_utf8) {
+	auto const validate = ParseOptions{.flags = ParseFlag::ValidateUtf8};
+	auto result = detail::Parser{"[\"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x84\", \"\\u00e9\"]", validate}.parse();
+	ASSERT(result);
+	EXPECT((*result)[0].as_string_view() == "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x84");
+
+	// overlong, surrogate, beyond U+10FFFF, truncated, lone continuation, invalid byte.
+	for (auto const invalid : {"\xc0\xaf", "\xe0\x80\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xe2\x82", "\x80", "\xff"}) {
+		auto const text = std::format(R"(["valid", "invalid {} here"])", invalid);
+		EXPECT(detail::Parser(text, ParseMode::Auto).parse());
+		result = detail::Parser{text, validate}.parse();
+		ASSERT(!result);
+		EXPECT(result.error().type == ErrType::InvalidUtf8);
+		EXPECT(result.error().offset == 10);
+	}
+
+	// escapes never produce or split a sequence.
+	for (auto const text : {R"(["\u00e9\b"])", "[\"\xc3\xa9\\b\"]"}) {
+		result = detail::Parser{text, validate}.parse();
+		ASSERT(result);
+		EXPECT((*result)[0].as_string_view() == "\xc3\xa9\b");
+	}
+	for (auto const text : {"[\"\xc3\\u0041\"]", "[\"\\u0041\xa9\"]", "[\"\\n\xe2\x82\"]"}) {
+		result = detail::Parser{text, validate}.parse();
+		ASSERT(!result);
+		EXPECT(result.error().type == ErrType::InvalidUtf8);
+	}
+
+	// long strings are validated in blocks, sequences may straddle them.
+	auto run = std::string{};
+	for (auto i = 0; i < 50; ++i) { run.append(i % 2 == 0 ? "\xe2\x82\xac" : "a\xf0\x9f\x98\x84"); }
+	EXPECT(detail::Parser(std::format(R"(["{}"])", run), validate).parse());
+	EXPECT(!detail::Parser(std::format(R"(["{}\xe2\x82"])", run), validate).parse());
+	EXPECT(!detail::Parser(std::format(R"(["{}\xed\xa0\x80{}"])", run, run), validate).parse());
+
+	result = detail::Parser{"{\n  \"k\": 1,\n  \"\xe2\x82\": 2\n}", validate}.parse();
+	ASSERT(!result);
+	EXPECT(result.error().type == ErrType::InvalidUtf8);
+	EXPECT(result.error().src_loc.line == 3 && result.error().src_loc.column == 3);
+	std::println("{}", to_string(result.error()));
 }
 
 TEST(parser_missing_key) {
@@ -240,4 +353,140 @@ TEST(parser_missing_brace) {
 	EXPECT(error.token.empty());
 	std::println("{}", to_string(error));
 }
+
+TEST(parser_max_depth) {
+	auto text = make_nested(max_depth_v);
+	auto json = expect_json(text);
+	EXPECT(json.is_array());
+
+	text = make_nested(100'000);
+	auto error = expect_error(text);
+	EXPECT(error.type == ErrType::MaxDepthExceeded);
+	EXPECT(error.src_loc.line == 1 && error.src_loc.column == max_depth_v + 1);
+	EXPECT(error.token == "[");
+	std::println("{}", to_string(error));
+
+	auto result = detail::Parser{R"({"a": [{"b": []}]})", ParseOptions{.max_depth = 3}}.parse();
+	EXPECT(!result && result.error().type == ErrType::MaxDepthExceeded && result.error().offset == 13);
+	result = detail::Parser{R"({"a": [{"b": 0}, {}]})", ParseOptions{.max_depth = 3}}.parse();
+	EXPECT(result && (*result)["a"][1].is_object());
+}
+
+TEST(parser_budgets) {
+	auto const parse = [](std::string_view const text, ParseOptions const& options) { return detail::Parser{text, options}.parse(); };
+	auto const fails_with = [](Result const& result, ErrType const type, std::uint64_t const offset) {
+		return !result && result.error().type == type && result.error().offset == offset;
+	};
+	constexpr auto text = std::string_view{R"({"key": "value", "array": [1, 2, 3]})"};
+
+	// budgets that are exactly met pass.
+	EXPECT(parse(text, ParseOptions{.max_size = text.size(), .max_string_length = 5, .max_elements = 3, .max_nodes = 6}));
+
+	auto result = parse(text, ParseOptions{.max_size = 10});
+	EXPECT(fails_with(result, ErrType::MaxSizeExceeded, 10));
+	EXPECT(result.error().src_loc.line == 1 && result.error().src_loc.column == 11);
+
+	result = parse(text, ParseOptions{.max_string_length = 4});
+	EXPECT(fails_with(result, ErrType::MaxStringLengthExceeded, 8));
+	EXPECT(result.error().token == R"("value")");
+	// keys count towards string length.
+	EXPECT(fails_with(parse(text, ParseOptions{.max_string_length = 2}), ErrType::MaxStringLengthExceeded, 1));
+	// as does input text, not unescaped text.
+	result = parse(R"("\n\n")", ParseOptions{.max_string_length = 3});
+	EXPECT(fails_with(result, ErrType::MaxStringLengthExceeded, 0));
+
+	result = parse(text, ParseOptions{.max_elements = 2});
+	EXPECT(fails_with(result, ErrType::MaxElementsExceeded, 33));
+	EXPECT(result.error().token == "3");
+
+	result = parse(text, ParseOptions{.max_nodes = 5});
+	EXPECT(fails_with(result, ErrType::MaxNodesExceeded, 33));
+
+	// parse errors before the budget is exceeded are reported first.
+	EXPECT(fails_with(parse("[1, 2 3, 4]", ParseOptions{.max_elements = 2}), ErrType::MissingBracket, 6));
+
+	// the parallel path defers to the serial one.
+	auto wide = std::string{"["};
+	for (auto i = 0; i < 100'000; ++i) { std::format_to(std::back_inserter(wide), "{},", i); }
+	wide.back() = ']';
+	EXPECT(Json::parse(wide, ParseOptions{.max_elements = 100'000, .threads = 4}));
+	auto const wide_result = Json::parse(wide, ParseOptions{.max_elements = 99'999, .threads = 4});
+	EXPECT(!wide_result && wide_result.error().type == ErrType::MaxElementsExceeded);
+	EXPECT(!Json::parse(wide, ParseOptions{.max_size = 1000, .threads = 4}));
+}
+
+TEST(parser_borrow_strings) {
+	auto const text = std::string{R"({"plain": "value", "esc\"aped": "line\nbreak", "array": ["a", ""]})"};
+	auto const is_borrowed = [&text](std::string_view const str) {
+		return std::less_equal<>{}(text.data(), str.data()) && std::less_equal<>{}(str.data() + str.size(), text.data() + text.size());
+	};
+
+	auto result = detail::Parser{text, ParseOptions{.flags = ParseFlag::BorrowStrings}}.parse();
+	ASSERT(result);
+	auto const& json = *result;
+	EXPECT(json["plain"].as_string_view() == "value" && is_borrowed(json["plain"].as_string_view()));
+	EXPECT(json["esc\"aped"].as_string_view() == "line\nbreak" && !is_borrowed(json["esc\"aped"].as_string_view()));
+	EXPECT(json["array"][0].as_string_view() == "a" && is_borrowed(json["array"][0].as_string_view()));
+	EXPECT(json["array"][1].as_string_view().empty());
+	for (auto const& [key, _] : json.as_object()) { EXPECT(key.is_borrowed() == is_borrowed(key.view())); }
+	EXPECT(json.as_object().find("plain")->first.is_borrowed());
+	EXPECT(!json.as_object().find("esc\"aped")->first.is_borrowed());
+
+	// borrowed and owned Json are equivalent.
+	auto const owned = detail::Parser{text, ParseMode::Auto}.parse();
+	ASSERT(owned);
+	EXPECT(owned->serialize() == json.serialize());
+	for (auto const& [key, _] : owned->as_object()) { EXPECT(!key.is_borrowed()); }
+
+	// modifying a borrowed Json copies only the modified value.
+	auto copy = json;
+	copy["plain"].set_string("modified");
+	copy.insert_or_assign("new", Json{});
+	EXPECT(copy["plain"].as_string_view() == "modified" && !is_borrowed(copy["plain"].as_string_view()));
+	EXPECT(copy["array"][0].as_string_view() == "a" && is_borrowed(copy["array"][0].as_string_view()));
+}
+
+TEST(parser_raw_numbers) {
+	auto const options = ParseOptions{.flags = ParseFlag::RawNumbers};
+	auto const text = std::string_view{R"([1.10,1e2,-0.0,123456789012345678901234567890,-42,18446744073709551615])"};
+	auto result = detail::Parser{text, options}.parse();
+	ASSERT(result);
+	auto const& json = *result;
+
+	// numbers round-trip byte-exact.
+	EXPECT(json.serialize(SerializeOptions{.flags = SerializeFlag::NoSpaces}) == text);
+
+	// converted on access.
+	EXPECT(json[0].as_double() == 1.1);
+	EXPECT(json[1].as_double() == 100.0);
+	EXPECT(json[3].as_double() == 123456789012345678901234567890.0);
+	EXPECT(json[4].as_i64() == -42);
+	EXPECT(json[4].as_i64() == -42);
+	EXPECT(json[5].as_u64() == std::numeric_limits<std::uint64_t>::max());
+
+	// copies keep the text (and any converted value).
+	auto copy = json;
+	EXPECT(copy[0].as_double() == 1.1);
+	EXPECT(copy[1].as_u64() == 100);
+	EXPECT(copy.serialize() == json.serialize());
+
+	// setting a number discards the text.
+	copy[0].set_number(2.5);
+	EXPECT(copy[0].as_double() == 2.5);
+	EXPECT(copy[0].serialize() == "2.5\n");
+	EXPECT(json[0].serialize() == "1.10\n");
+
+	// numbers are still validated.
+	for (auto const invalid : {"01", "1.", "-", "1e"}) {
+		auto const invalid_result = detail::Parser{invalid, options}.parse();
+		ASSERT(!invalid_result);
+		EXPECT(invalid_result.error().type == Error::Type::InvalidNumber);
+	}
+	// out of range exactly when converting.
+	for (auto const edge : {"1e400", "1e-400", "1e308", "0e999", "123456789012345678901234567890e290"}) {
+		auto const raw = detail::Parser{edge, options}.parse();
+		auto const converted = detail::Parser{edge, ParseMode::Auto}.parse();
+		EXPECT(raw.has_value() == converted.has_value());
+	}
+}
 } // namespace
@@ -1,4 +1,6 @@
 #include <detail/scanner.hpp>
+#include <unit_test.hpp>
+#include <string>
 
 namespace {
 using namespace dj::detail;
@@ -44,7 +46,8 @@ struct Fixture : Scanner {
 		auto err = result.error();
 		if (err.type != type) { return false; }
 		if (err.token != lexeme) { return false; }
-		return err.src_loc.line == line && err.src_loc.column == column;
+		auto const src_loc = get_src_loc(err.offset);
+		return src_loc.line == line && src_loc.column == column;
 	}
 
 	Token token{};
@@ -130,6 +133,12 @@ constexpr auto test_unrecognized_token() {
 	return fixture.expect_error(ErrType::UnrecognizedToken, "$", 1, 8);
 }
 
+constexpr auto test_partial_keyword() {
+	auto fixture = Fixture{R"([nul])"};
+	if (!fixture.expect_operator(Op::SquareLeft)) { return false; }
+	return fixture.expect_error(ErrType::UnrecognizedToken, "n", 1, 2);
+}
+
 constexpr auto test_missing_quote() {
 	auto fixture = Fixture{R"(42
 "abc)"};
@@ -153,6 +162,45 @@ static_assert(test_eof_line_comment());
 static_assert(test_multiline_comment());
 static_assert(test_eof_multiline_comment());
 static_assert(test_unrecognized_token());
+static_assert(test_partial_keyword());
 static_assert(test_missing_quote());
 static_assert(test_missing_end_comment());
+
+// runtime: exercises the block scanning paths, which are bypassed in constant evaluation.
+TEST(scanner_find_non_ascii) {
+	// a start index near the end: the last block includes non-ASCII bytes before it.
+	auto const text = "xx\xc3\xa9" + std::string(14, 'a');
+	for (auto index = 4uz; index <= text.size(); ++index) { EXPECT(simd::find_non_ascii(text, index) == text.size()); }
+	auto const euro = text + "\xe2\x82\xac";
+	for (auto index = 4uz; index <= text.size(); ++index) { EXPECT(simd::find_non_ascii(euro, index) == text.size()); }
+	EXPECT(simd::find_non_ascii(euro, 1) == 2);
+	EXPECT(simd::find_non_ascii(euro, 3) == 3);
+}
+
+TEST(scanner_blocks) {
+	auto text = "[" + std::string(37, ' ');
+	text += "\n\t\r\n" + std::string(20, ' ');
+	text += '"' + std::string(45, 'a') + R"(\"\\)" + std::string(17, 'b') + R"(\")" + '"';
+	text += std::string(33, '\n');
+	text += R"("end")";
+
+	auto fixture = Fixture{text};
+	EXPECT(fixture.expect_operator(Op::SquareLeft));
+	ASSERT(fixture.expect_token());
+	ASSERT(fixture.token.is<token::String>());
+	auto const& escaped = std::get<token::String>(fixture.token.type).escaped;
+	EXPECT(escaped.size() == 45 + 4 + 17 + 2);
+	EXPECT(escaped.ends_with(R"(b\")"));
+	auto src_loc = fixture.get_src_loc(fixture.token.offset);
+	EXPECT(src_loc.line == 3 && src_loc.column == 21);
+
+	EXPECT(fixture.expect_string("end"));
+	src_loc = fixture.get_src_loc(fixture.token.offset);
+	EXPECT(src_loc.line == 36 && src_loc.column == 1);
+	EXPECT(fixture.expect_eof());
+
+	text = R"("unterminated \")" + std::string(40, 'x') + "\\";
+	fixture = Fixture{text};
+	EXPECT(!fixture.next());
+}
 } // namespace
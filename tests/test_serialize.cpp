@@ -85,5 +85,15 @@ TEST(serialize_escape) {
 	ASSERT(result);
 	json = std::move(*result);
 	EXPECT(json.as_string() == text);
+
+	// control characters with short escapes round trip.
+	text = "back\bspace form\ffeed";
+	expected = R"("back\bspace form\ffeed")";
+	json.set_string(text);
+	str = json.serialize(SerializeOptions{.flags = SerializeFlag::NoSpaces});
+	EXPECT(str == expected);
+	result = Json::parse(str);
+	ASSERT(result);
+	EXPECT(result->as_string() == text);
 }
 } // namespace
@@ -0,0 +1,83 @@
+#include <detail/shared_string.hpp>
+#include <djson/json.hpp>
+#include <unit_test.hpp>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+using namespace dj;
+
+template <bool Atomic>
+void test_basic_shared_string() {
+	using SharedString = detail::BasicSharedString<Atomic>;
+	auto* string = SharedString::make("shared text");
+	EXPECT(string->get_text() == "shared text");
+	EXPECT(string->is_unique());
+
+	SharedString::retain(string);
+	EXPECT(!string->is_unique());
+	// shared: immutable.
+	EXPECT(!string->try_overwrite("other"));
+	SharedString::release(string);
+
+	EXPECT(string->try_overwrite("other"));
+	EXPECT(string->get_text() == "other");
+	// larger than the allocation.
+	EXPECT(!string->try_overwrite("longer than the original text"));
+	SharedString::release(string);
+
+	auto* empty = SharedString::make({});
+	EXPECT(empty->get_text().empty());
+	SharedString::release(empty);
+}
+
+TEST(shared_string_basic) {
+	test_basic_shared_string<true>();
+	test_basic_shared_string<false>();
+}
+
+TEST(shared_string_json_copy) {
+	auto const text = std::string(100, 'x');
+	auto json = Json{text};
+	auto copy = json;
+	EXPECT(copy.as_string_view() == text);
+	// copies share the text.
+	EXPECT(copy.as_string_view().data() == json.as_string_view().data());
+
+	// setting either leaves the other unchanged.
+	copy.set_string(std::string(100, 'y'));
+	EXPECT(json.as_string_view() == text);
+	EXPECT(copy.as_string_view() == std::string(100, 'y'));
+
+	copy = json;
+	EXPECT(copy.as_string_view().data() == json.as_string_view().data());
+	copy = std::as_const(copy);
+	EXPECT(copy.as_string_view() == text);
+	json = nullptr;
+	EXPECT(copy.as_string_view() == text);
+
+	auto const parsed = Json::parse(R"({"message": "a string too long to be stored inline"})");
+	ASSERT(parsed);
+	auto const message = parsed.value();
+	EXPECT(message["message"].as_string_view().data() == (*parsed)["message"].as_string_view().data());
+}
+
+TEST(shared_string_threads) {
+	if constexpr (!detail::atomic_refcount_v) { return; }
+	auto const source = Json::parse(R"(["a string too long to be stored inline", {"key": "another string too long to be stored inline"}])");
+	ASSERT(source);
+	auto threads = std::vector<std::jthread>{};
+	for (int i = 0; i < 4; ++i) {
+		threads.emplace_back([&json = *source] {
+			for (int j = 0; j < 1000; ++j) {
+				auto const copy = json;
+				(void)copy;
+			}
+		});
+	}
+	threads.clear();
+	EXPECT(std::as_const(*source)[0].as_string_view() == "a string too long to be stored inline");
+}
+} // namespace